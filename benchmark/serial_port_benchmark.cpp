@@ -0,0 +1,852 @@
+/*************************************************************************/
+/*  serial_port_benchmark.cpp                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+// Standalone benchmark of the native paths SerialPort is built on, driven over
+// pseudo terminals so it needs neither hardware nor a running engine. Each runs
+// the std-only code SerialPort itself calls, minus the Variant conversions:
+//
+//   read_raw   SerialLineReader::read() through SerialLink::io(), as used by
+//              SerialPort.read_raw()
+//   read_line  SerialLineReader::buffer_line(), as used by SerialPort.read_line()
+//   monitor    SerialLink's event-driven monitor filling the SPSC receive
+//              buffer with receive_into(), drained by another thread, as used
+//              by start_monitoring()
+//   write_raw  serial::Serial::write() through SerialLink::io(), as used by
+//              SerialPort.write_raw()
+//
+// Usage: serial_port_benchmark [--low-latency] [megabytes] [latency_samples]
+//        serial_port_benchmark --stress [seconds]
+//        serial_port_benchmark --modbus [transactions]
+// Prints one JSON object per benchmark. Syscall and allocation counts are
+// those of the threads on the SerialPort side only, syscalls being read/write
+// syscalls (Linux only, 0 elsewhere). --low-latency
+// applies SerialPort.low_latency first and prints which settings took effect,
+// pseudo terminals have no driver latency to tune so mostly VMIN/VTIME do.
+//
+// --stress runs SerialLink, the locking and monitor thread of SerialPort, on
+// one port that is read, written, reconfigured, closed and reopened at once,
+// and exits non-zero if a byte got lost or reordered. Build with
+// `benchmark_sanitizer=thread` to have ThreadSanitizer check it too.
+//
+// --modbus runs ModbusRTU, the wire side of ModbusRTUMaster, against a slave
+// simulated on the device side: reads, writes, exceptions, a missing slave and
+// CRC errors with and without retries, then a run of polls. It exits non-zero
+// if a result is wrong or the slave saw a request before the silent interval
+// since the previous frame was over.
+
+#include "modbus_rtu.h"
+#include "serial/serial.h"
+#include "serial_checksum.h"
+#include "serial_line_reader.h"
+#include "serial_link.h"
+#include "serial_low_latency.h"
+#include "serial_port_lock.h"
+#include "spsc_ring_buffer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#ifdef __APPLE__
+#include <util.h>
+#else
+#include <pty.h>
+#endif
+
+static const size_t CHUNK_SIZE = 4096;
+static const size_t MESSAGE_SIZE = 16;
+
+// Allocations made so far by the current thread.
+static thread_local uint64_t thread_allocations = 0;
+static bool low_latency = false;
+
+void *operator new(size_t size) {
+	thread_allocations++;
+	void *ptr = malloc(size ? size : 1);
+	if (!ptr) {
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void operator delete(void *ptr) noexcept {
+	free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+	free(ptr);
+}
+
+static uint64_t _ticks_nsec() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static long _get_thread_id() {
+#ifdef __linux__
+	return syscall(SYS_gettid);
+#else
+	return 0;
+#endif
+}
+
+// Read and write syscalls made so far by the given thread of this process.
+static uint64_t _thread_syscalls(long tid) {
+	if (tid == 0) {
+		return 0;
+	}
+	char path[64];
+	snprintf(path, sizeof(path), "/proc/self/task/%ld/io", tid);
+	FILE *file = fopen(path, "r");
+	if (!file) {
+		return 0;
+	}
+	uint64_t count = 0;
+	char key[32];
+	unsigned long long value;
+	while (fscanf(file, "%31[^:]: %llu\n", key, &value) == 2) {
+		if (strcmp(key, "syscr") == 0 || strcmp(key, "syscw") == 0) {
+			count += value;
+		}
+	}
+	fclose(file);
+	return count;
+}
+
+struct Counts {
+	std::atomic<uint64_t> syscalls{ 0 };
+	std::atomic<uint64_t> allocations{ 0 };
+};
+
+// Adds the syscalls and allocations made by the current thread during its
+// lifetime to `total`.
+struct MeasureScope {
+	Counts *total;
+	long tid;
+	uint64_t syscalls_start;
+	uint64_t allocations_start;
+
+	explicit MeasureScope(Counts *p_total) :
+			total(p_total), tid(_get_thread_id()), syscalls_start(p_total ? _thread_syscalls(tid) : 0), allocations_start(thread_allocations) {}
+	~MeasureScope() {
+		if (total) {
+			total->syscalls += _thread_syscalls(tid) - syscalls_start;
+			total->allocations += thread_allocations - allocations_start;
+		}
+	}
+};
+
+struct Pty {
+	int master = -1;
+	int slave = -1;
+	std::string name;
+
+	bool open() {
+		char buf[256];
+		if (openpty(&master, &slave, buf, nullptr, nullptr) != 0) {
+			return false;
+		}
+		name = buf;
+		struct termios tio;
+		tcgetattr(slave, &tio);
+		cfmakeraw(&tio);
+		tcsetattr(slave, TCSANOW, &tio);
+		return true;
+	}
+
+	~Pty() {
+		if (master >= 0) {
+			::close(master);
+		}
+		if (slave >= 0) {
+			::close(slave);
+		}
+	}
+};
+
+static void _write_all(int fd, const uint8_t *data, size_t size) {
+	while (size > 0) {
+		ssize_t n = ::write(fd, data, size);
+		if (n <= 0) {
+			continue;
+		}
+		data += n;
+		size -= n;
+	}
+}
+
+struct Benchmark {
+	const char *name;
+	// Pushes all bytes into the link.
+	std::function<void(const uint8_t *, size_t)> send;
+	// Blocks until at least one byte came out of the link, returns how many.
+	std::function<size_t(uint8_t *, size_t)> receive;
+	// Whether `send` rather than `receive` is the SerialPort side.
+	bool measure_send = false;
+	// Another thread working on the SerialPort side, if any, and the
+	// allocations it has made so far.
+	std::atomic<long> *helper_thread = nullptr;
+	std::atomic<uint64_t> *helper_allocations = nullptr;
+};
+
+static void _run(const Benchmark &bench, size_t total, int samples) {
+	Counts counts;
+	std::vector<uint8_t> out(CHUNK_SIZE), in(CHUNK_SIZE);
+	for (size_t i = 0; i < CHUNK_SIZE; i++) {
+		out[i] = i % 64 == 63 ? '\n' : 'a' + i % 26;
+	}
+	long helper_tid = bench.helper_thread ? bench.helper_thread->load() : 0;
+	uint64_t helper_syscalls = _thread_syscalls(helper_tid);
+	uint64_t helper_allocations = bench.helper_allocations ? bench.helper_allocations->load() : 0;
+
+	uint64_t start = _ticks_nsec();
+	std::thread sender([&]() {
+		MeasureScope scope(bench.measure_send ? &counts : nullptr);
+		for (size_t sent = 0; sent < total; sent += CHUNK_SIZE) {
+			bench.send(out.data(), CHUNK_SIZE);
+		}
+	});
+	{
+		MeasureScope scope(bench.measure_send ? nullptr : &counts);
+		for (size_t received = 0; received < total;) {
+			received += bench.receive(in.data(), CHUNK_SIZE);
+		}
+	}
+	sender.join();
+	double seconds = (_ticks_nsec() - start) / 1e9;
+	uint64_t syscalls = counts.syscalls + _thread_syscalls(helper_tid) - helper_syscalls;
+	uint64_t allocations = counts.allocations;
+	if (bench.helper_allocations) {
+		allocations += bench.helper_allocations->load() - helper_allocations;
+	}
+
+	// Ping-pong: one message in flight, timestamped by the sender.
+	std::vector<double> latencies(samples);
+	std::atomic<int> acked{ -1 };
+	sender = std::thread([&]() {
+		uint8_t message[MESSAGE_SIZE] = {};
+		for (int i = 0; i < samples; i++) {
+			uint64_t now = _ticks_nsec();
+			memcpy(message, &now, sizeof(now));
+			message[MESSAGE_SIZE - 1] = '\n';
+			bench.send(message, MESSAGE_SIZE);
+			while (acked.load(std::memory_order_acquire) != i) {
+				std::this_thread::yield();
+			}
+		}
+	});
+	for (int i = 0; i < samples; i++) {
+		uint8_t message[MESSAGE_SIZE];
+		for (size_t received = 0; received < MESSAGE_SIZE;) {
+			received += bench.receive(message + received, MESSAGE_SIZE - received);
+		}
+		uint64_t sent;
+		memcpy(&sent, message, sizeof(sent));
+		latencies[i] = (_ticks_nsec() - sent) / 1e3;
+		acked.store(i, std::memory_order_release);
+	}
+	sender.join();
+	std::sort(latencies.begin(), latencies.end());
+
+	auto percentile = [&](double p) { return latencies.empty() ? 0.0 : latencies[std::min(latencies.size() - 1, size_t(latencies.size() * p))]; };
+	double kb = total / 1024.0;
+	printf("{\"benchmark\": \"%s\", \"low_latency\": %s, \"bytes\": %zu, \"seconds\": %.4f, \"mb_per_s\": %.2f, "
+		   "\"latency_us\": {\"p50\": %.1f, \"p99\": %.1f, \"p999\": %.1f}, "
+		   "\"syscalls_per_kb\": %.3f, \"allocations_per_kb\": %.3f}\n",
+			bench.name, low_latency ? "true" : "false", total, seconds, total / seconds / (1024 * 1024),
+			percentile(0.5), percentile(0.99), percentile(0.999),
+			syscalls / kb, allocations / kb);
+	fflush(stdout);
+}
+
+// Opens the port through `link`, as SerialPort.open() does.
+static bool _open_serial(serial::Serial &serial, const Pty &pty, SerialLink &link) {
+	try {
+		return link.open([&]() {
+			serial.setPort(pty.name);
+			serial::Timeout timeout = serial::Timeout::simpleTimeout(1000);
+			serial.setTimeout(timeout);
+			serial.open();
+			return true;
+		});
+	} catch (std::exception &e) {
+		fprintf(stderr, "Failed to open %s: %s\n", pty.name.c_str(), e.what());
+		return false;
+	}
+}
+
+// Both directions carry the byte sequence offset % 251, checked on arrival.
+static uint8_t _sequence_byte(uint64_t offset) {
+	return offset % 251;
+}
+
+struct Stress {
+	serial::Serial &serial;
+	const Pty &pty;
+	SerialPortStats stats;
+	SerialLink link{ stats };
+	std::atomic<uint64_t> rx_bytes{ 0 };
+	std::atomic<uint64_t> mismatches{ 0 };
+	std::atomic<uint64_t> errors{ 0 };
+
+	Stress(serial::Serial &p_serial, const Pty &p_pty) :
+			serial(p_serial), pty(p_pty) {}
+};
+
+static void _stress_close(Stress &stress) {
+	stress.link.close([&]() { stress.serial.close(); });
+}
+
+static bool _stress_start_monitoring(Stress &stress) {
+	SerialLink::Callbacks callbacks;
+	callbacks.user_data = &stress;
+	callbacks.can_read = [](void *p_user_data) {
+		return static_cast<Stress *>(p_user_data)->link.is_receiving();
+	};
+	callbacks.get_retry_delay = [](void *p_user_data) {
+		// Backing off is simulated by the reconfiguring thread, retry soon.
+		return static_cast<Stress *>(p_user_data)->link.is_receiving() ? int64_t(-1) : int64_t(1000);
+	};
+	callbacks.open_fd = [](void *p_user_data) {
+		return ::open(static_cast<Stress *>(p_user_data)->pty.name.c_str(), O_RDONLY | O_NOCTTY | O_NONBLOCK);
+	};
+	callbacks.receive = [](void *p_user_data, uint64_t) {
+		Stress *stress = static_cast<Stress *>(p_user_data);
+		uint8_t buf[CHUNK_SIZE];
+		try {
+			size_t n = stress->link.io([&]() {
+				return stress->serial.read(buf, std::min(sizeof(buf), stress->serial.available()));
+			});
+			uint64_t offset = stress->rx_bytes;
+			for (size_t i = 0; i < n; i++) {
+				stress->mismatches += buf[i] != _sequence_byte(offset + i);
+			}
+			stress->rx_bytes += n;
+		} catch (std::exception &e) {
+			stress->errors++;
+		}
+	};
+	callbacks.on_error = [](void *p_user_data, const char *p_where, const char *p_what) {
+		fprintf(stderr, "%s: %s\n", p_where, p_what);
+		static_cast<Stress *>(p_user_data)->errors++;
+	};
+	return stress.link.start_monitoring(SerialLink::MONITOR_EVENT_DRIVEN, 1000, callbacks);
+}
+
+// Runs SerialLink, the core of SerialPort, over a pseudo terminal: the monitor
+// reads, another thread writes, and a third reconfigures, stops receiving as
+// if backing off, closes and reopens the port and restarts the monitor.
+static int _stress(serial::Serial &serial, const Pty &pty, int seconds) {
+	Stress stress(serial, pty);
+	// The device side keeps draining until the port side has stopped.
+	std::atomic<bool> port_should_exit{ false };
+	std::atomic<bool> device_should_exit{ false };
+	std::atomic<uint64_t> tx_bytes{ 0 };
+	std::atomic<uint64_t> reconfigurations{ 0 };
+	std::atomic<uint64_t> reopens{ 0 };
+
+	if (!_open_serial(stress.serial, stress.pty, stress.link) || !_stress_start_monitoring(stress)) {
+		return 1;
+	}
+
+	fcntl(pty.master, F_SETFL, fcntl(pty.master, F_GETFL) | O_NONBLOCK);
+	std::thread device_writer([&]() {
+		uint8_t buf[CHUNK_SIZE];
+		uint64_t offset = 0;
+		while (!device_should_exit) {
+			struct pollfd fds = { pty.master, POLLOUT, 0 };
+			if (::poll(&fds, 1, 100) <= 0) {
+				continue;
+			}
+			for (size_t i = 0; i < sizeof(buf); i++) {
+				buf[i] = _sequence_byte(offset + i);
+			}
+			ssize_t n = ::write(pty.master, buf, sizeof(buf));
+			offset += n > 0 ? n : 0;
+		}
+	});
+	std::thread device_reader([&]() {
+		uint8_t buf[CHUNK_SIZE];
+		uint64_t offset = 0;
+		while (!device_should_exit) {
+			struct pollfd fds = { pty.master, POLLIN, 0 };
+			if (::poll(&fds, 1, 100) <= 0) {
+				continue;
+			}
+			ssize_t n = ::read(pty.master, buf, sizeof(buf));
+			for (ssize_t i = 0; i < n; i++, offset++) {
+				stress.mismatches += buf[i] != _sequence_byte(offset);
+			}
+		}
+	});
+
+	std::thread port_writer([&]() {
+		uint8_t buf[256];
+		while (!port_should_exit) {
+			uint64_t offset = tx_bytes;
+			for (size_t i = 0; i < sizeof(buf); i++) {
+				buf[i] = _sequence_byte(offset + i);
+			}
+			try {
+				tx_bytes += stress.link.io([&]() { return serial.write(buf, sizeof(buf)); });
+			} catch (std::exception &e) {
+				stress.errors++;
+			}
+			if (!stress.link.is_open()) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		}
+	});
+	std::thread reconfigurer([&]() {
+		const uint32_t baudrates[] = { 115200, 230400 };
+		for (uint64_t cycle = 0; !port_should_exit; cycle++) {
+			try {
+				if (cycle % 50 == 49) {
+					_stress_close(stress);
+					if (cycle % 200 == 199) {
+						stress.link.stop_monitoring();
+						stress.errors += !_stress_start_monitoring(stress);
+					}
+					stress.errors += !_open_serial(stress.serial, stress.pty, stress.link);
+					reopens++;
+				} else if (cycle % 10 == 9) {
+					// What SerialPort does backing off after an error.
+					stress.link.set_receiving(false);
+				} else {
+					std::unique_lock<SerialPortLock> lock(stress.link.get_lock());
+					serial.setBaudrate(baudrates[reconfigurations % 2]);
+					serial::Timeout timeout = serial::Timeout::simpleTimeout(100 + reconfigurations % 2);
+					serial.setTimeout(timeout);
+					reconfigurations++;
+				}
+			} catch (std::exception &e) {
+				stress.errors++;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			if (!stress.link.is_receiving()) {
+				stress.link.set_receiving(true);
+				stress.link.wakeup();
+			}
+		}
+	});
+
+	std::this_thread::sleep_for(std::chrono::seconds(seconds));
+	port_should_exit = true;
+	for (std::thread *thread : { &reconfigurer, &port_writer }) {
+		thread->join();
+	}
+	stress.link.stop_monitoring();
+	_stress_close(stress);
+	device_should_exit = true;
+	device_reader.join();
+	device_writer.join();
+
+	uint64_t mismatches = stress.mismatches;
+	uint64_t errors = stress.errors;
+	bool passed = stress.rx_bytes > 0 && tx_bytes > 0 && reopens > 0 && mismatches == 0 && errors == 0;
+	printf("{\"benchmark\": \"stress\", \"seconds\": %d, \"rx_bytes\": %llu, \"tx_bytes\": %llu, \"reconfigurations\": %llu, "
+		   "\"reopens\": %llu, \"monitor_wakeups\": %llu, \"mismatches\": %llu, \"errors\": %llu, \"passed\": %s}\n",
+			seconds, (unsigned long long)stress.rx_bytes, (unsigned long long)tx_bytes, (unsigned long long)reconfigurations,
+			(unsigned long long)reopens, (unsigned long long)stress.stats.monitor_wakeups, (unsigned long long)mismatches,
+			(unsigned long long)errors, passed ? "true" : "false");
+	return passed ? 0 : 1;
+}
+
+// The monitor benchmark's port side, as a SerialPort with monitoring started.
+struct Monitor {
+	serial::Serial &serial;
+	const Pty &pty;
+	SerialLink &link;
+	SPSCRingBuffer rx_buffer;
+	std::atomic<long> tid{ 0 };
+	std::atomic<uint64_t> allocations{ 0 };
+
+	Monitor(serial::Serial &p_serial, const Pty &p_pty, SerialLink &p_link) :
+			serial(p_serial), pty(p_pty), link(p_link) {}
+};
+
+static bool _monitor_start(Monitor &monitor) {
+	SerialLink::Callbacks callbacks;
+	callbacks.user_data = &monitor;
+	callbacks.can_read = [](void *p_user_data) {
+		Monitor *monitor = static_cast<Monitor *>(p_user_data);
+		if (monitor->tid == 0) {
+			monitor->tid = _get_thread_id();
+		}
+		return true;
+	};
+	callbacks.get_retry_delay = [](void *) {
+		return int64_t(-1);
+	};
+	callbacks.open_fd = [](void *p_user_data) {
+		return ::open(static_cast<Monitor *>(p_user_data)->pty.name.c_str(), O_RDONLY | O_NOCTTY | O_NONBLOCK);
+	};
+	callbacks.receive = [](void *p_user_data, uint64_t) {
+		Monitor *monitor = static_cast<Monitor *>(p_user_data);
+		size_t available = monitor->link.io([&]() { return monitor->serial.available(); });
+		monitor->link.receive_into(
+				monitor->rx_buffer, available,
+				[&](uint8_t *p_buffer, size_t p_size) {
+					return monitor->link.io([&]() { return monitor->serial.read(p_buffer, p_size); });
+				},
+				[](size_t) {});
+		monitor->allocations = thread_allocations;
+	};
+	callbacks.on_error = [](void *, const char *p_where, const char *p_what) {
+		fprintf(stderr, "%s: %s\n", p_where, p_what);
+	};
+	// No coalescing, every read is delivered at once.
+	return monitor.link.start_monitoring(SerialLink::MONITOR_EVENT_DRIVEN, 0, callbacks);
+}
+
+// Holding registers of the simulated Modbus slave.
+static const uint16_t MODBUS_REGISTER_COUNT = 100;
+// Responses about this register get a broken CRC but every third.
+static const uint16_t MODBUS_CORRUPT_ADDRESS = 50;
+
+struct ModbusSlave {
+	const Pty &pty;
+	uint8_t slave_id = 1;
+	uint16_t registers[MODBUS_REGISTER_COUNT] = {};
+	uint64_t corrupt_responses = 0;
+	// When the last byte was last on the line, and the shortest quiet time seen
+	// before a request.
+	uint64_t line_busy_until = 0;
+	uint64_t min_gap = UINT64_MAX;
+	std::atomic<bool> should_exit{ false };
+
+	explicit ModbusSlave(const Pty &p_pty) :
+			pty(p_pty) {}
+};
+
+static void _modbus_answer(ModbusSlave &slave, const uint8_t *request, size_t size) {
+	if (size < 8 || !SerialChecksum::verify(SerialChecksum::TYPE_CRC16_MODBUS, request, size, false) || request[0] != slave.slave_id) {
+		return;
+	}
+	uint8_t function = request[1];
+	uint16_t address = (request[2] << 8) | request[3];
+	uint16_t value = (request[4] << 8) | request[5];
+	std::vector<uint8_t> response = { request[0], function };
+	uint8_t exception_code = 0;
+	switch (function) {
+		case ModbusRTU::FUNCTION_READ_HOLDING_REGISTERS:
+			if (address + value > MODBUS_REGISTER_COUNT) {
+				exception_code = 2;
+				break;
+			}
+			response.push_back(2 * value);
+			for (uint16_t i = 0; i < value; i++) {
+				response.push_back(slave.registers[address + i] >> 8);
+				response.push_back(slave.registers[address + i] & 0xFF);
+			}
+			break;
+		case ModbusRTU::FUNCTION_WRITE_SINGLE_REGISTER:
+		case ModbusRTU::FUNCTION_WRITE_MULTIPLE_REGISTERS: {
+			bool single = function == ModbusRTU::FUNCTION_WRITE_SINGLE_REGISTER;
+			uint16_t count = single ? 1 : value;
+			if (address + count > MODBUS_REGISTER_COUNT || (!single && size != 9 + 2 * size_t(count))) {
+				exception_code = 2;
+				break;
+			}
+			const uint8_t *values = request + (single ? 4 : 7);
+			for (uint16_t i = 0; i < count; i++) {
+				slave.registers[address + i] = (values[2 * i] << 8) | values[2 * i + 1];
+			}
+			response.assign(request, request + 6);
+		} break;
+		default:
+			exception_code = 1;
+			break;
+	}
+	if (exception_code) {
+		response = { request[0], uint8_t(function | 0x80), exception_code };
+	}
+
+	response.resize(response.size() + 2);
+	SerialChecksum::encode(SerialChecksum::TYPE_CRC16_MODBUS, SerialChecksum::compute(SerialChecksum::TYPE_CRC16_MODBUS, response.data(), response.size() - 2), false, response.data() + response.size() - 2);
+	if (address == MODBUS_CORRUPT_ADDRESS && slave.corrupt_responses++ % 3 != 2) {
+		response.back() ^= 0xFF;
+	}
+	_write_all(slave.pty.master, response.data(), response.size());
+	slave.line_busy_until = _ticks_nsec() / 1000;
+}
+
+static void _modbus_slave_loop(ModbusSlave &slave) {
+	uint8_t request[ModbusRTU::MAX_ADU_SIZE];
+	size_t size = 0;
+	while (!slave.should_exit) {
+		struct pollfd fds = { slave.pty.master, POLLIN, 0 };
+		// Pseudo terminals deliver at once, a millisecond without data ends a frame.
+		if (::poll(&fds, 1, size > 0 ? 1 : 50) > 0) {
+			ssize_t n = ::read(slave.pty.master, request + size, sizeof(request) - size);
+			if (n <= 0) {
+				continue;
+			}
+			uint64_t now = _ticks_nsec() / 1000;
+			if (size == 0 && slave.line_busy_until > 0) {
+				slave.min_gap = std::min(slave.min_gap, now - slave.line_busy_until);
+			}
+			size += n;
+			slave.line_busy_until = now;
+			continue;
+		}
+		if (size > 0) {
+			_modbus_answer(slave, request, size);
+			size = 0;
+		}
+	}
+}
+
+struct ModbusPort {
+	serial::Serial &serial;
+	SerialLink &link;
+};
+
+// Runs ModbusRTU over a pseudo terminal against a simulated slave, see above.
+static int _modbus(serial::Serial &serial, const Pty &pty, int transactions) {
+	SerialPortStats stats;
+	SerialLink link(stats);
+	if (!_open_serial(serial, pty, link)) {
+		return 1;
+	}
+	ModbusPort modbus_port = { serial, link };
+	ModbusRTU::Port port;
+	port.user_data = &modbus_port;
+	port.available = [](void *p_user_data) {
+		ModbusPort *port = static_cast<ModbusPort *>(p_user_data);
+		return port->link.io([&]() { return port->serial.available(); });
+	};
+	port.read = [](void *p_user_data, uint8_t *p_buffer, size_t p_size) {
+		ModbusPort *port = static_cast<ModbusPort *>(p_user_data);
+		return port->link.io([&]() { return port->serial.read(p_buffer, p_size); });
+	};
+	port.write = [](void *p_user_data, const uint8_t *p_data, size_t p_size) {
+		ModbusPort *port = static_cast<ModbusPort *>(p_user_data);
+		return port->link.io([&]() { return port->serial.write(p_data, p_size); });
+	};
+	port.flush_input = [](void *p_user_data) {
+		ModbusPort *port = static_cast<ModbusPort *>(p_user_data);
+		port->link.io([&]() {
+			port->serial.flushInput();
+			return size_t(0);
+		});
+	};
+	ModbusRTU rtu;
+	rtu.set_port(port);
+	// 8N1 at 19200 baud, the fastest rate with a silent interval of 3.5 characters.
+	rtu.set_timing(19200, 8, false, 2);
+
+	ModbusSlave slave(pty);
+	std::thread slave_thread([&]() { _modbus_slave_loop(slave); });
+
+	int failures = 0;
+	auto check = [&](const char *p_name, const ModbusRTU::Request &p_request, int p_retries, int p_error, int p_exception_code, const std::vector<int32_t> &p_values) {
+		std::vector<int32_t> values(p_request.count);
+		int exception_code = 0;
+		int error = rtu.transact(p_request, 20, p_retries, 0, values.data(), &exception_code);
+		bool read = ModbusRTU::is_read(p_request.function) && error == 0;
+		if (error != p_error || exception_code != p_exception_code || (read && values != p_values)) {
+			fprintf(stderr, "%s: error %d, exception %d, expected error %d, exception %d%s\n", p_name, error, exception_code, p_error, p_exception_code,
+					read && values != p_values ? ", wrong values" : "");
+			failures++;
+		}
+	};
+	const uint8_t id = slave.slave_id;
+	check("write_multiple_registers", ModbusRTU::make_request(id, ModbusRTU::FUNCTION_WRITE_MULTIPLE_REGISTERS, 10, 3, { 0, 1, 0, 2, 0, 3 }), 0, 0, 0, {});
+	check("read_holding_registers", ModbusRTU::make_request(id, ModbusRTU::FUNCTION_READ_HOLDING_REGISTERS, 10, 3, {}), 0, 0, 0, { 1, 2, 3 });
+	check("write_single_register", ModbusRTU::make_request(id, ModbusRTU::FUNCTION_WRITE_SINGLE_REGISTER, 11, 1, { 0x12, 0x34 }), 0, 0, 0, {});
+	check("read_written_register", ModbusRTU::make_request(id, ModbusRTU::FUNCTION_READ_HOLDING_REGISTERS, 11, 1, {}), 0, 0, 0, { 0x1234 });
+	check("illegal_address", ModbusRTU::make_request(id, ModbusRTU::FUNCTION_READ_HOLDING_REGISTERS, MODBUS_REGISTER_COUNT - 1, 2, {}), 0, ModbusRTU::ERROR_EXCEPTION, 2, {});
+	check("illegal_function", ModbusRTU::make_request(id, ModbusRTU::FUNCTION_READ_COILS, 0, 1, {}), 0, ModbusRTU::ERROR_EXCEPTION, 1, {});
+	check("missing_slave", ModbusRTU::make_request(id + 1, ModbusRTU::FUNCTION_READ_HOLDING_REGISTERS, 0, 1, {}), 0, ModbusRTU::ERROR_TIMEOUT, 0, {});
+	check("crc_error", ModbusRTU::make_request(id, ModbusRTU::FUNCTION_READ_HOLDING_REGISTERS, MODBUS_CORRUPT_ADDRESS, 1, {}), 0, ModbusRTU::ERROR_CRC, 0, {});
+	check("crc_error_retried", ModbusRTU::make_request(id, ModbusRTU::FUNCTION_READ_HOLDING_REGISTERS, MODBUS_CORRUPT_ADDRESS, 1, {}), 1, 0, 0, { 0 });
+
+	ModbusRTU::Request poll = ModbusRTU::make_request(id, ModbusRTU::FUNCTION_READ_HOLDING_REGISTERS, 10, 3, {});
+	uint64_t start = _ticks_nsec();
+	for (int i = 0; i < transactions; i++) {
+		check("poll", poll, 0, 0, 0, { 1, 0x1234, 3 });
+	}
+	double seconds = (_ticks_nsec() - start) / 1e9;
+
+	slave.should_exit = true;
+	slave_thread.join();
+	link.close([&]() { serial.close(); });
+
+	uint64_t silent_interval = rtu.get_silent_interval();
+	bool passed = failures == 0 && slave.min_gap >= silent_interval;
+	printf("{\"benchmark\": \"modbus\", \"transactions\": %d, \"seconds\": %.4f, \"transactions_per_s\": %.1f, "
+		   "\"silent_interval_us\": %llu, \"min_gap_us\": %llu, \"failures\": %d, \"passed\": %s}\n",
+			transactions, seconds, transactions / seconds, (unsigned long long)silent_interval, (unsigned long long)slave.min_gap,
+			failures, passed ? "true" : "false");
+	return passed ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+	if (argc > 1 && strcmp(argv[1], "--stress") == 0) {
+		Pty pty;
+		serial::Serial serial;
+		if (!pty.open()) {
+			return 1;
+		}
+		return _stress(serial, pty, argc > 2 ? atoi(argv[2]) : 10);
+	}
+	if (argc > 1 && strcmp(argv[1], "--modbus") == 0) {
+		Pty pty;
+		serial::Serial serial;
+		if (!pty.open()) {
+			return 1;
+		}
+		return _modbus(serial, pty, argc > 2 ? atoi(argv[2]) : 1000);
+	}
+	if (argc > 1 && strcmp(argv[1], "--low-latency") == 0) {
+		low_latency = true;
+		argc--;
+		argv++;
+	}
+	size_t total = (argc > 1 ? strtoul(argv[1], nullptr, 10) : 64) * 1024 * 1024;
+	int samples = argc > 2 ? atoi(argv[2]) : 10000;
+	total -= total % CHUNK_SIZE;
+
+	Pty pty;
+	serial::Serial serial;
+	SerialPortStats stats;
+	SerialLink link(stats);
+	if (!pty.open() || !_open_serial(serial, pty, link)) {
+		return 1;
+	}
+	SerialLowLatency low_latency_settings;
+	if (low_latency) {
+		const SerialLowLatency::Status &status = low_latency_settings.enable(pty.name);
+		printf("{\"low_latency_status\": {\"async_low_latency\": %s, \"vmin_vtime\": %s, \"latency_timer\": %d}}\n",
+				status.async_low_latency ? "true" : "false", status.vmin_vtime ? "true" : "false", status.latency_timer);
+	}
+	auto send_master = [&](const uint8_t *data, size_t size) { _write_all(pty.master, data, size); };
+	// What SerialPort's _available() and _read_bytes() do, minus error reporting.
+	auto port_available = [&]() {
+		return link.io([&]() { return serial.available(); });
+	};
+	auto port_read = [&](uint8_t *p_buffer, size_t p_size) {
+		return link.io([&]() { return serial.read(p_buffer, p_size); });
+	};
+	SerialLineReader line_reader;
+
+	{
+		Benchmark bench;
+		bench.name = "read_raw";
+		bench.send = send_master;
+		// As a script calling read_raw(available()), blocking for a byte when
+		// there are none.
+		bench.receive = [&](uint8_t *buf, size_t size) {
+			return line_reader.read(buf, std::max<size_t>(1, std::min(size, port_available())), port_read);
+		};
+		_run(bench, total, samples);
+	}
+
+	{
+		const uint8_t eol = '\n';
+		Benchmark bench;
+		bench.name = "read_line";
+		bench.send = send_master;
+		// One line per call, what is left of a line longer than asked for
+		// stays buffered for the next.
+		bench.receive = [&](uint8_t *buf, size_t size) {
+			size_t line = std::min(size, line_reader.buffer_line(SIZE_MAX, &eol, 1, port_available, port_read));
+			memcpy(buf, line_reader.get_data(), line);
+			line_reader.consume(line);
+			return line;
+		};
+		_run(bench, total, samples);
+	}
+
+	{
+		Monitor monitor(serial, pty, link);
+		monitor.rx_buffer.resize(65536);
+		if (!_monitor_start(monitor)) {
+			return 1;
+		}
+
+		Benchmark bench;
+		bench.name = "monitor";
+		bench.send = send_master;
+		// What SerialPort's drain_into() and _rx_consumed() do.
+		bench.receive = [&](uint8_t *buf, size_t size) {
+			size_t read;
+			while ((read = monitor.rx_buffer.read(buf, size)) == 0) {
+				std::this_thread::yield();
+			}
+			monitor.link.unblock_receive();
+			return read;
+		};
+		bench.helper_thread = &monitor.tid;
+		bench.helper_allocations = &monitor.allocations;
+		while (monitor.tid == 0 && _get_thread_id() != 0) {
+			std::this_thread::yield();
+		}
+		_run(bench, total, samples);
+		link.stop_monitoring();
+	}
+
+	{
+		Benchmark bench;
+		bench.name = "write_raw";
+		bench.send = [&](const uint8_t *data, size_t size) {
+			while (size > 0) {
+				size_t written = link.io([&]() { return serial.write(data, size); });
+				data += written;
+				size -= written;
+			}
+		};
+		bench.receive = [&](uint8_t *buf, size_t size) {
+			ssize_t read = ::read(pty.master, buf, size);
+			return read > 0 ? size_t(read) : 0;
+		};
+		bench.measure_send = true;
+		_run(bench, total, samples);
+	}
+
+	return 0;
+}
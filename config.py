@@ -9,6 +9,9 @@ def configure(env):
 def get_doc_classes():
     return [
         "SerialPort",
+        "SerialPortManager",
+        "ModbusRTUMaster",
+        "SerialReadRequest",
     ]
 
 
@@ -0,0 +1,204 @@
+/*************************************************************************/
+/*  modbus_rtu.cpp                                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "modbus_rtu.h"
+
+#include "serial_checksum.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+using namespace std::chrono;
+
+static inline uint64_t _ticks_usec() {
+	return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+bool ModbusRTU::is_read(Function p_function) {
+	return p_function <= FUNCTION_READ_INPUT_REGISTERS;
+}
+
+bool ModbusRTU::is_bit_function(Function p_function) {
+	return p_function == FUNCTION_READ_COILS || p_function == FUNCTION_READ_DISCRETE_INPUTS || p_function == FUNCTION_WRITE_MULTIPLE_COILS;
+}
+
+ModbusRTU::Request ModbusRTU::make_request(uint8_t p_slave_id, Function p_function, uint16_t p_address, uint16_t p_count, const std::vector<uint8_t> &p_payload) {
+	Request request;
+	request.slave_id = p_slave_id;
+	request.function = p_function;
+	request.address = p_address;
+	request.count = p_count;
+
+	std::vector<uint8_t> &frame = request.frame;
+	frame = { p_slave_id, uint8_t(p_function), uint8_t(p_address >> 8), uint8_t(p_address & 0xFF) };
+	if (p_function == FUNCTION_WRITE_MULTIPLE_COILS || p_function == FUNCTION_WRITE_MULTIPLE_REGISTERS) {
+		frame.insert(frame.end(), { uint8_t(p_count >> 8), uint8_t(p_count & 0xFF), uint8_t(p_payload.size()) });
+	} else if (is_read(p_function)) {
+		frame.insert(frame.end(), { uint8_t(p_count >> 8), uint8_t(p_count & 0xFF) });
+	}
+	frame.insert(frame.end(), p_payload.begin(), p_payload.end());
+	frame.resize(frame.size() + 2);
+	SerialChecksum::encode(SerialChecksum::TYPE_CRC16_MODBUS, SerialChecksum::compute(SerialChecksum::TYPE_CRC16_MODBUS, frame.data(), frame.size() - 2), false, frame.data() + frame.size() - 2);
+	return request;
+}
+
+int ModbusRTU::parse_response(const Request &p_request, const uint8_t *p_frame, size_t p_size, int32_t *r_values, int *r_exception_code) {
+	if (p_size < 5 || p_frame[0] != p_request.slave_id) {
+		return ERROR_MALFORMED;
+	}
+	if (!SerialChecksum::verify(SerialChecksum::TYPE_CRC16_MODBUS, p_frame, p_size, false)) {
+		return ERROR_CRC;
+	}
+	if (p_frame[1] == (p_request.function | 0x80)) {
+		*r_exception_code = p_frame[2];
+		return ERROR_EXCEPTION;
+	}
+	if (p_frame[1] != p_request.function) {
+		return ERROR_MALFORMED;
+	}
+
+	if (!is_read(p_request.function)) {
+		// Writes echo the address, and the value or the quantity written.
+		if (p_size != 8 || memcmp(p_frame + 2, p_request.frame.data() + 2, 4) != 0) {
+			return ERROR_MALFORMED;
+		}
+		return 0;
+	}
+
+	bool bits = is_bit_function(p_request.function);
+	size_t data_size = bits ? (p_request.count + 7) / 8 : 2 * size_t(p_request.count);
+	if (p_frame[2] != data_size || p_size != 5 + data_size) {
+		return ERROR_MALFORMED;
+	}
+	const uint8_t *data = p_frame + 3;
+	for (int i = 0; i < p_request.count; i++) {
+		if (bits) {
+			r_values[i] = (data[i / 8] >> (i % 8)) & 1;
+		} else {
+			r_values[i] = (data[2 * i] << 8) | data[2 * i + 1];
+		}
+	}
+	return 0;
+}
+
+void ModbusRTU::set_timing(uint32_t p_baudrate, int p_data_bits, bool p_parity, int p_stop_half_bits) {
+	uint64_t baudrate = std::max(p_baudrate, 1u);
+	// Start bit, data bits, parity bit and stop bits, in half bits for 1.5 stop bits.
+	uint64_t half_bits = 2 + 2 * p_data_bits + (p_parity ? 2 : 0) + p_stop_half_bits;
+	char_time = (half_bits * 1000000 + baudrate) / (2 * baudrate);
+	// The specification fixes the interval above 19200 baud, where 3.5 characters
+	// would be too short for most UARTs to tell apart.
+	silent_interval = baudrate > 19200 ? 1750 : (char_time * 7 + 1) / 2;
+}
+
+size_t ModbusRTU::_receive_frame(uint8_t *p_buffer, size_t p_capacity, const Request &p_request, uint64_t p_sent_until, int p_response_timeout) {
+	size_t received = 0;
+	uint64_t last_byte = p_sent_until;
+	uint64_t deadline = p_sent_until + uint64_t(p_response_timeout) * 1000;
+	// Half a character keeps the silent interval accurate without spinning.
+	microseconds nap(std::clamp(char_time / 2, uint64_t(50), uint64_t(1000)));
+
+	while (received < p_capacity) {
+		size_t available = port.available(port.user_data);
+		if (available > 0) {
+			size_t bytes_read = port.read(port.user_data, p_buffer + received, std::min(available, p_capacity - received));
+			if (bytes_read == 0) {
+				break;
+			}
+			received += bytes_read;
+			last_byte = _ticks_usec();
+
+			// Stop as soon as the frame is known to be complete, the silent
+			// interval is then kept before the next request instead.
+			size_t expected = 0;
+			if (received >= 2 && (p_buffer[1] & 0x80)) {
+				expected = 5;
+			} else if (is_read(p_request.function)) {
+				expected = received >= 3 ? 5 + size_t(p_buffer[2]) : 0;
+			} else {
+				expected = 8;
+			}
+			if (expected > 0 && received >= expected) {
+				break;
+			}
+			continue;
+		}
+
+		uint64_t now = _ticks_usec();
+		if (received == 0 ? now >= deadline : now - last_byte >= silent_interval) {
+			break;
+		}
+		std::this_thread::sleep_for(nap);
+	}
+
+	bus_idle_at = std::max(bus_idle_at, last_byte + silent_interval);
+	return received;
+}
+
+int ModbusRTU::transact(const Request &p_request, int p_response_timeout, int p_retries, int p_turnaround_delay, int32_t *r_values, int *r_exception_code) {
+	uint8_t response[MAX_ADU_SIZE];
+	int error = 0;
+	for (int attempt = 0; attempt <= p_retries; attempt++) {
+		uint64_t now = _ticks_usec();
+		if (now < bus_idle_at) {
+			std::this_thread::sleep_for(microseconds(bus_idle_at - now));
+		}
+
+		// Leftovers of an earlier, late response would corrupt this one.
+		port.flush_input(port.user_data);
+		size_t written = port.write(port.user_data, p_request.frame.data(), p_request.frame.size());
+		if (written != p_request.frame.size()) {
+			return ERROR_IO;
+		}
+		// write() returns while the UART is still shifting the frame out.
+		uint64_t sent_until = _ticks_usec() + p_request.frame.size() * char_time;
+		bus_idle_at = sent_until + silent_interval;
+
+		if (p_request.slave_id == 0) {
+			// Nobody answers a broadcast, give the slaves time to process it.
+			bus_idle_at = sent_until + uint64_t(p_turnaround_delay) * 1000;
+			return 0;
+		}
+
+		size_t size = _receive_frame(response, MAX_ADU_SIZE, p_request, sent_until, p_response_timeout);
+		*r_exception_code = 0;
+		if (size == 0) {
+			error = ERROR_TIMEOUT;
+			continue;
+		}
+		error = parse_response(p_request, response, size, r_values, r_exception_code);
+		if (error == 0 || error == ERROR_EXCEPTION) {
+			break;
+		}
+	}
+	return error;
+}
@@ -0,0 +1,118 @@
+/*************************************************************************/
+/*  modbus_rtu.h                                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef MODBUS_RTU_H
+#define MODBUS_RTU_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// The wire side of ModbusRTUMaster: building frames, keeping the silent
+// intervals between them and running a request/response transaction with
+// retries. std-only so the benchmark's Modbus test runs the same code against
+// a simulated slave. The port is passed in as calls on the owner's port.
+class ModbusRTU {
+public:
+	enum Function {
+		FUNCTION_READ_COILS = 1,
+		FUNCTION_READ_DISCRETE_INPUTS = 2,
+		FUNCTION_READ_HOLDING_REGISTERS = 3,
+		FUNCTION_READ_INPUT_REGISTERS = 4,
+		FUNCTION_WRITE_SINGLE_COIL = 5,
+		FUNCTION_WRITE_SINGLE_REGISTER = 6,
+		FUNCTION_WRITE_MULTIPLE_COILS = 15,
+		FUNCTION_WRITE_MULTIPLE_REGISTERS = 16,
+	};
+	enum Error {
+		ERROR_TIMEOUT = 1,
+		ERROR_CRC,
+		ERROR_MALFORMED,
+		ERROR_EXCEPTION,
+		ERROR_IO,
+	};
+
+	struct Port {
+		void *user_data = nullptr;
+		size_t (*available)(void *p_user_data) = nullptr;
+		// Only asked for bytes available() reported.
+		size_t (*read)(void *p_user_data, uint8_t *p_buffer, size_t p_size) = nullptr;
+		size_t (*write)(void *p_user_data, const uint8_t *p_data, size_t p_size) = nullptr;
+		void (*flush_input)(void *p_user_data) = nullptr;
+	};
+
+	struct Request {
+		uint8_t slave_id = 0;
+		Function function = FUNCTION_READ_HOLDING_REGISTERS;
+		uint16_t address = 0;
+		uint16_t count = 0;
+		// Complete ADU, CRC included.
+		std::vector<uint8_t> frame;
+	};
+
+	// Largest RTU frame allowed by the specification.
+	static const size_t MAX_ADU_SIZE = 256;
+
+private:
+	Port port;
+	// Set by set_timing(), in microseconds.
+	uint64_t char_time = 0;
+	uint64_t silent_interval = 0;
+	// Earliest time the next request may be sent.
+	uint64_t bus_idle_at = 0;
+
+	size_t _receive_frame(uint8_t *p_buffer, size_t p_capacity, const Request &p_request, uint64_t p_sent_until, int p_response_timeout);
+
+public:
+	static bool is_read(Function p_function);
+	static bool is_bit_function(Function p_function);
+
+	// Frames `p_payload`, the values of a write, into a request.
+	static Request make_request(uint8_t p_slave_id, Function p_function, uint16_t p_address, uint16_t p_count, const std::vector<uint8_t> &p_payload);
+	// Checks a response to `p_request`. Returns 0 or an Error, and for reads
+	// stores the `p_request.count` coils or registers in `r_values`.
+	static int parse_response(const Request &p_request, const uint8_t *p_frame, size_t p_size, int32_t *r_values, int *r_exception_code);
+
+	void set_port(const Port &p_port) { port = p_port; }
+	// `p_stop_half_bits` is 2, 3 or 4 for 1, 1.5 or 2 stop bits.
+	void set_timing(uint32_t p_baudrate, int p_data_bits, bool p_parity, int p_stop_half_bits);
+	uint64_t get_char_time() const { return char_time; }
+	uint64_t get_silent_interval() const { return silent_interval; }
+	// Forgets when the bus was last busy.
+	void reset() { bus_idle_at = 0; }
+
+	// Sends `p_request` once the bus is idle and receives its response, retried
+	// `p_retries` times on timeouts and CRC or framing errors. Returns 0 or an
+	// Error, parsed as by parse_response(). Broadcasts, to slave 0, wait
+	// `p_turnaround_delay` milliseconds before the bus is idle again instead.
+	int transact(const Request &p_request, int p_response_timeout, int p_retries, int p_turnaround_delay, int32_t *r_values, int *r_exception_code);
+};
+
+#endif // MODBUS_RTU_H
@@ -0,0 +1,449 @@
+/*************************************************************************/
+/*  modbus_rtu_master.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "modbus_rtu_master.h"
+
+#ifdef GDEXTENSION
+#include <godot_cpp/core/class_db.hpp>
+
+using namespace godot;
+#else
+#include "core/object/class_db.h"
+#endif
+
+#include <chrono>
+
+using namespace std::chrono;
+
+static inline uint64_t _ticks_usec() {
+	return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static bool _is_read(ModbusRTUMaster::Function function) {
+	return ModbusRTU::is_read(ModbusRTU::Function(function));
+}
+
+static bool _is_bit_function(ModbusRTUMaster::Function function) {
+	return ModbusRTU::is_bit_function(ModbusRTU::Function(function));
+}
+
+size_t ModbusRTUMaster::_port_available(void *p_user_data) {
+	return static_cast<ModbusRTUMaster *>(p_user_data)->serial_port->_available("ModbusRTUMaster");
+}
+
+size_t ModbusRTUMaster::_port_read(void *p_user_data, uint8_t *p_buffer, size_t p_size) {
+	return static_cast<ModbusRTUMaster *>(p_user_data)->serial_port->_read_bytes(p_buffer, p_size, "ModbusRTUMaster");
+}
+
+size_t ModbusRTUMaster::_port_write(void *p_user_data, const uint8_t *p_data, size_t p_size) {
+	return static_cast<ModbusRTUMaster *>(p_user_data)->serial_port->_write_bytes(p_data, p_size, "ModbusRTUMaster");
+}
+
+void ModbusRTUMaster::_port_flush_input(void *p_user_data) {
+	static_cast<ModbusRTUMaster *>(p_user_data)->serial_port->flush_input();
+}
+
+void ModbusRTUMaster::_thread_func(void *p_user_data) {
+	ModbusRTUMaster *master = static_cast<ModbusRTUMaster *>(p_user_data);
+	master->_thread_loop();
+}
+
+void ModbusRTUMaster::_thread_loop() {
+	std::unique_lock<std::mutex> lock(mutex);
+	uint64_t next_cycle = _ticks_usec();
+	size_t poll_index = 0;
+	bool in_cycle = false;
+
+	while (!should_exit) {
+		Request request;
+		bool cycle_completed = false;
+		if (!pending.empty()) {
+			request = pending.front();
+			pending.pop_front();
+		} else if (!polls.empty() && (in_cycle || _ticks_usec() >= next_cycle)) {
+			if (!in_cycle) {
+				in_cycle = true;
+				poll_index = 0;
+				next_cycle = _ticks_usec() + uint64_t(poll_interval) * 1000;
+			}
+			request = polls[poll_index++];
+			// remove_poll() may shrink the list in the middle of a cycle.
+			cycle_completed = poll_index >= polls.size();
+			in_cycle = !cycle_completed;
+		} else {
+			if (polls.empty()) {
+				cond.wait(lock);
+			} else {
+				cond.wait_until(lock, steady_clock::time_point(microseconds(next_cycle)));
+			}
+			continue;
+		}
+
+		// The lists and settings may change while the bus is busy, the
+		// request is a copy and the settings are taken along with it.
+		int timeout = response_timeout;
+		int retry_count = retries;
+		int delay = turnaround_delay;
+		lock.unlock();
+		Result result = _transact(request, timeout, retry_count, delay);
+		lock.lock();
+
+		results.push_back(result);
+		if (cycle_completed) {
+			Result marker;
+			marker.cycle_completed = true;
+			results.push_back(marker);
+		}
+		if (!results_notify_pending.exchange(true)) {
+			call_deferred("_results_received");
+		}
+	}
+}
+
+void ModbusRTUMaster::_update_timing() {
+	ERR_FAIL_NULL(serial_port);
+	int stop_half_bits = 2;
+	switch (serial_port->get_stopbits()) {
+		case SerialPort::STOPBITS_1:
+			stop_half_bits = 2;
+			break;
+		case SerialPort::STOPBITS_2:
+			stop_half_bits = 4;
+			break;
+		case SerialPort::STOPBITS_1P5:
+			stop_half_bits = 3;
+			break;
+	}
+	rtu.set_timing(serial_port->get_baudrate(), serial_port->get_bytesize(), serial_port->get_parity() != SerialPort::PARITY_NONE, stop_half_bits);
+}
+
+ModbusRTUMaster::Result ModbusRTUMaster::_transact(const Request &request, int timeout, int retry_count, int delay) {
+	Result result;
+	result.id = request.id;
+	result.slave_id = request.rtu.slave_id;
+	result.function = Function(request.rtu.function);
+	result.address = request.rtu.address;
+	if (_is_read(result.function)) {
+		result.values.resize(request.rtu.count);
+	}
+	result.error = rtu.transact(request.rtu, timeout, retry_count, delay, result.values.ptrw(), &result.exception_code);
+	return result;
+}
+
+void ModbusRTUMaster::_results_received() {
+	results_notify_pending = false;
+	std::vector<Result> received;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		received.swap(results);
+	}
+	for (const Result &result : received) {
+		if (result.cycle_completed) {
+			emit_signal("cycle_completed");
+		} else if (result.error != 0) {
+			emit_signal("request_failed", result.id, result.slave_id, result.function, result.error, result.exception_code);
+		} else {
+			emit_signal("response_received", result.id, result.slave_id, result.function, result.address, result.values);
+		}
+	}
+}
+
+int64_t ModbusRTUMaster::_add_request(bool poll, uint8_t slave_id, Function function, uint16_t address, uint16_t count, const std::vector<uint8_t> &payload) {
+	Request request;
+	request.rtu = ModbusRTU::make_request(slave_id, ModbusRTU::Function(function), address, count, payload);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		request.id = ++last_id;
+		if (poll) {
+			polls.push_back(request);
+		} else {
+			pending.push_back(request);
+		}
+	}
+	cond.notify_one();
+	return request.id;
+}
+
+void ModbusRTUMaster::_detach_serial_port() {
+	stop();
+	serial_port = nullptr;
+}
+
+void ModbusRTUMaster::set_serial_port(SerialPort *port) {
+	ERR_FAIL_COND_MSG(is_running(), "Can't change the port while running.");
+	if (port == serial_port) {
+		return;
+	}
+	ERR_FAIL_COND_MSG(port && port->modbus_master, "The serial port already has a Modbus master.");
+	if (serial_port) {
+		serial_port->modbus_master = nullptr;
+	}
+	serial_port = port;
+	if (serial_port) {
+		serial_port->modbus_master = this;
+	}
+}
+
+SerialPort *ModbusRTUMaster::get_serial_port() const {
+	return serial_port;
+}
+
+void ModbusRTUMaster::set_response_timeout(int msec) {
+	ERR_FAIL_COND(msec <= 0);
+	std::lock_guard<std::mutex> lock(mutex);
+	response_timeout = msec;
+}
+
+int ModbusRTUMaster::get_response_timeout() const {
+	return response_timeout;
+}
+
+void ModbusRTUMaster::set_poll_interval(int msec) {
+	ERR_FAIL_COND(msec < 0);
+	std::lock_guard<std::mutex> lock(mutex);
+	poll_interval = msec;
+}
+
+int ModbusRTUMaster::get_poll_interval() const {
+	return poll_interval;
+}
+
+void ModbusRTUMaster::set_retries(int count) {
+	ERR_FAIL_COND(count < 0);
+	std::lock_guard<std::mutex> lock(mutex);
+	retries = count;
+}
+
+int ModbusRTUMaster::get_retries() const {
+	return retries;
+}
+
+void ModbusRTUMaster::set_turnaround_delay(int msec) {
+	ERR_FAIL_COND(msec < 0);
+	std::lock_guard<std::mutex> lock(mutex);
+	turnaround_delay = msec;
+}
+
+int ModbusRTUMaster::get_turnaround_delay() const {
+	return turnaround_delay;
+}
+
+int ModbusRTUMaster::get_char_time() {
+	ERR_FAIL_NULL_V(serial_port, 0);
+	if (!is_running()) {
+		_update_timing();
+	}
+	return rtu.get_char_time();
+}
+
+int ModbusRTUMaster::get_silent_interval() {
+	ERR_FAIL_NULL_V(serial_port, 0);
+	if (!is_running()) {
+		_update_timing();
+	}
+	return rtu.get_silent_interval();
+}
+
+int64_t ModbusRTUMaster::add_poll(int slave_id, Function function, int address, int count) {
+	ERR_FAIL_COND_V_MSG(!_is_read(function), 0, "Only read functions can be polled.");
+	ERR_FAIL_COND_V(slave_id < 1 || slave_id > 247, 0);
+	ERR_FAIL_COND_V(address < 0 || address > 0xFFFF, 0);
+	ERR_FAIL_COND_V(count < 1 || count > (_is_bit_function(function) ? 2000 : 125), 0);
+	return _add_request(true, slave_id, function, address, count, {});
+}
+
+void ModbusRTUMaster::remove_poll(int64_t id) {
+	std::lock_guard<std::mutex> lock(mutex);
+	for (size_t i = 0; i < polls.size(); i++) {
+		if (polls[i].id == id) {
+			polls.erase(polls.begin() + i);
+			return;
+		}
+	}
+}
+
+void ModbusRTUMaster::clear_polls() {
+	std::lock_guard<std::mutex> lock(mutex);
+	polls.clear();
+}
+
+int64_t ModbusRTUMaster::read(int slave_id, Function function, int address, int count) {
+	ERR_FAIL_COND_V_MSG(!_is_read(function), 0, "Not a read function.");
+	ERR_FAIL_COND_V(slave_id < 1 || slave_id > 247, 0);
+	ERR_FAIL_COND_V(address < 0 || address > 0xFFFF, 0);
+	ERR_FAIL_COND_V(count < 1 || count > (_is_bit_function(function) ? 2000 : 125), 0);
+	return _add_request(false, slave_id, function, address, count, {});
+}
+
+int64_t ModbusRTUMaster::write_single_coil(int slave_id, int address, bool value) {
+	ERR_FAIL_COND_V(slave_id < 0 || slave_id > 247, 0);
+	ERR_FAIL_COND_V(address < 0 || address > 0xFFFF, 0);
+	return _add_request(false, slave_id, FUNCTION_WRITE_SINGLE_COIL, address, 1, { uint8_t(value ? 0xFF : 0x00), 0x00 });
+}
+
+int64_t ModbusRTUMaster::write_single_register(int slave_id, int address, int value) {
+	ERR_FAIL_COND_V(slave_id < 0 || slave_id > 247, 0);
+	ERR_FAIL_COND_V(address < 0 || address > 0xFFFF, 0);
+	return _add_request(false, slave_id, FUNCTION_WRITE_SINGLE_REGISTER, address, 1, { uint8_t((value >> 8) & 0xFF), uint8_t(value & 0xFF) });
+}
+
+int64_t ModbusRTUMaster::write_multiple_coils(int slave_id, int address, const PackedInt32Array &values) {
+	ERR_FAIL_COND_V(slave_id < 0 || slave_id > 247, 0);
+	ERR_FAIL_COND_V(address < 0 || address > 0xFFFF, 0);
+	ERR_FAIL_COND_V(values.size() < 1 || values.size() > 1968, 0);
+	std::vector<uint8_t> payload((values.size() + 7) / 8, 0);
+	for (int i = 0; i < values.size(); i++) {
+		if (values[i]) {
+			payload[i / 8] |= 1 << (i % 8);
+		}
+	}
+	return _add_request(false, slave_id, FUNCTION_WRITE_MULTIPLE_COILS, address, values.size(), payload);
+}
+
+int64_t ModbusRTUMaster::write_multiple_registers(int slave_id, int address, const PackedInt32Array &values) {
+	ERR_FAIL_COND_V(slave_id < 0 || slave_id > 247, 0);
+	ERR_FAIL_COND_V(address < 0 || address > 0xFFFF, 0);
+	ERR_FAIL_COND_V(values.size() < 1 || values.size() > 123, 0);
+	std::vector<uint8_t> payload;
+	for (int i = 0; i < values.size(); i++) {
+		payload.push_back((values[i] >> 8) & 0xFF);
+		payload.push_back(values[i] & 0xFF);
+	}
+	return _add_request(false, slave_id, FUNCTION_WRITE_MULTIPLE_REGISTERS, address, values.size(), payload);
+}
+
+Error ModbusRTUMaster::start() {
+	ERR_FAIL_COND_V_MSG(is_running(), ERR_ALREADY_IN_USE, "Already running.");
+	ERR_FAIL_NULL_V_MSG(serial_port, ERR_UNCONFIGURED, "No serial port set.");
+	ERR_FAIL_COND_V_MSG(!serial_port->is_open(), ERR_UNCONFIGURED, "Serial port not open.");
+	ERR_FAIL_COND_V_MSG(!serial_port->monitoring_should_exit, ERR_BUSY, "The serial port monitor would take the responses, stop monitoring first.");
+
+	_update_timing();
+	rtu.reset();
+	should_exit = false;
+	thread = std::thread(_thread_func, this);
+	return OK;
+}
+
+void ModbusRTUMaster::stop() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		should_exit = true;
+		pending.clear();
+	}
+	cond.notify_one();
+	if (thread.joinable()) {
+		thread.join();
+	}
+}
+
+bool ModbusRTUMaster::is_running() const {
+	return thread.joinable();
+}
+
+ModbusRTUMaster::ModbusRTUMaster() {
+	ModbusRTU::Port port;
+	port.user_data = this;
+	port.available = _port_available;
+	port.read = _port_read;
+	port.write = _port_write;
+	port.flush_input = _port_flush_input;
+	rtu.set_port(port);
+}
+
+ModbusRTUMaster::~ModbusRTUMaster() {
+	stop();
+	if (serial_port) {
+		serial_port->modbus_master = nullptr;
+	}
+}
+
+void ModbusRTUMaster::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("_results_received"), &ModbusRTUMaster::_results_received);
+
+	ClassDB::bind_method(D_METHOD("set_serial_port", "port"), &ModbusRTUMaster::set_serial_port);
+	ClassDB::bind_method(D_METHOD("get_serial_port"), &ModbusRTUMaster::get_serial_port);
+	ClassDB::bind_method(D_METHOD("set_response_timeout", "msec"), &ModbusRTUMaster::set_response_timeout);
+	ClassDB::bind_method(D_METHOD("get_response_timeout"), &ModbusRTUMaster::get_response_timeout);
+	ClassDB::bind_method(D_METHOD("set_poll_interval", "msec"), &ModbusRTUMaster::set_poll_interval);
+	ClassDB::bind_method(D_METHOD("get_poll_interval"), &ModbusRTUMaster::get_poll_interval);
+	ClassDB::bind_method(D_METHOD("set_retries", "count"), &ModbusRTUMaster::set_retries);
+	ClassDB::bind_method(D_METHOD("get_retries"), &ModbusRTUMaster::get_retries);
+	ClassDB::bind_method(D_METHOD("set_turnaround_delay", "msec"), &ModbusRTUMaster::set_turnaround_delay);
+	ClassDB::bind_method(D_METHOD("get_turnaround_delay"), &ModbusRTUMaster::get_turnaround_delay);
+	ClassDB::bind_method(D_METHOD("get_char_time"), &ModbusRTUMaster::get_char_time);
+	ClassDB::bind_method(D_METHOD("get_silent_interval"), &ModbusRTUMaster::get_silent_interval);
+
+	ClassDB::bind_method(D_METHOD("add_poll", "slave_id", "function", "address", "count"), &ModbusRTUMaster::add_poll);
+	ClassDB::bind_method(D_METHOD("remove_poll", "id"), &ModbusRTUMaster::remove_poll);
+	ClassDB::bind_method(D_METHOD("clear_polls"), &ModbusRTUMaster::clear_polls);
+	ClassDB::bind_method(D_METHOD("read", "slave_id", "function", "address", "count"), &ModbusRTUMaster::read);
+	ClassDB::bind_method(D_METHOD("write_single_coil", "slave_id", "address", "value"), &ModbusRTUMaster::write_single_coil);
+	ClassDB::bind_method(D_METHOD("write_single_register", "slave_id", "address", "value"), &ModbusRTUMaster::write_single_register);
+	ClassDB::bind_method(D_METHOD("write_multiple_coils", "slave_id", "address", "values"), &ModbusRTUMaster::write_multiple_coils);
+	ClassDB::bind_method(D_METHOD("write_multiple_registers", "slave_id", "address", "values"), &ModbusRTUMaster::write_multiple_registers);
+
+	ClassDB::bind_method(D_METHOD("start"), &ModbusRTUMaster::start);
+	ClassDB::bind_method(D_METHOD("stop"), &ModbusRTUMaster::stop);
+	ClassDB::bind_method(D_METHOD("is_running"), &ModbusRTUMaster::is_running);
+
+	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "serial_port", PROPERTY_HINT_NONE, "SerialPort"), "set_serial_port", "get_serial_port");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "response_timeout"), "set_response_timeout", "get_response_timeout");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "poll_interval"), "set_poll_interval", "get_poll_interval");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "retries"), "set_retries", "get_retries");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "turnaround_delay"), "set_turnaround_delay", "get_turnaround_delay");
+
+#ifndef GDEXTENSION
+	ADD_PROPERTY_DEFAULT("response_timeout", 100);
+	ADD_PROPERTY_DEFAULT("poll_interval", 100);
+	ADD_PROPERTY_DEFAULT("retries", 0);
+	ADD_PROPERTY_DEFAULT("turnaround_delay", 100);
+#endif
+
+	ADD_SIGNAL(MethodInfo("response_received", PropertyInfo(Variant::INT, "id"), PropertyInfo(Variant::INT, "slave_id"), PropertyInfo(Variant::INT, "function"), PropertyInfo(Variant::INT, "address"), PropertyInfo(Variant::PACKED_INT32_ARRAY, "values")));
+	ADD_SIGNAL(MethodInfo("request_failed", PropertyInfo(Variant::INT, "id"), PropertyInfo(Variant::INT, "slave_id"), PropertyInfo(Variant::INT, "function"), PropertyInfo(Variant::INT, "error"), PropertyInfo(Variant::INT, "exception_code")));
+	ADD_SIGNAL(MethodInfo("cycle_completed"));
+
+	BIND_ENUM_CONSTANT(FUNCTION_READ_COILS);
+	BIND_ENUM_CONSTANT(FUNCTION_READ_DISCRETE_INPUTS);
+	BIND_ENUM_CONSTANT(FUNCTION_READ_HOLDING_REGISTERS);
+	BIND_ENUM_CONSTANT(FUNCTION_READ_INPUT_REGISTERS);
+	BIND_ENUM_CONSTANT(FUNCTION_WRITE_SINGLE_COIL);
+	BIND_ENUM_CONSTANT(FUNCTION_WRITE_SINGLE_REGISTER);
+	BIND_ENUM_CONSTANT(FUNCTION_WRITE_MULTIPLE_COILS);
+	BIND_ENUM_CONSTANT(FUNCTION_WRITE_MULTIPLE_REGISTERS);
+
+	BIND_ENUM_CONSTANT(REQUEST_ERROR_TIMEOUT);
+	BIND_ENUM_CONSTANT(REQUEST_ERROR_CRC);
+	BIND_ENUM_CONSTANT(REQUEST_ERROR_MALFORMED);
+	BIND_ENUM_CONSTANT(REQUEST_ERROR_EXCEPTION);
+	BIND_ENUM_CONSTANT(REQUEST_ERROR_IO);
+}
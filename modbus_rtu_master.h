@@ -0,0 +1,171 @@
+/*************************************************************************/
+/*  modbus_rtu_master.h                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef MODBUS_RTU_MASTER_H
+#define MODBUS_RTU_MASTER_H
+
+#include "modbus_rtu.h"
+#include "serial_port.h"
+
+#ifdef GDEXTENSION
+#include <godot_cpp/classes/ref_counted.hpp>
+#else
+#include "core/object/ref_counted.h"
+#endif
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Modbus RTU master running its requests on a thread of its own, so the
+// silent intervals between frames are timed natively instead of from script.
+// The frames and their timing are ModbusRTU's, this schedules the requests.
+class ModbusRTUMaster : public RefCounted {
+	GDCLASS(ModbusRTUMaster, RefCounted);
+
+public:
+	enum Function {
+		FUNCTION_READ_COILS = ModbusRTU::FUNCTION_READ_COILS,
+		FUNCTION_READ_DISCRETE_INPUTS = ModbusRTU::FUNCTION_READ_DISCRETE_INPUTS,
+		FUNCTION_READ_HOLDING_REGISTERS = ModbusRTU::FUNCTION_READ_HOLDING_REGISTERS,
+		FUNCTION_READ_INPUT_REGISTERS = ModbusRTU::FUNCTION_READ_INPUT_REGISTERS,
+		FUNCTION_WRITE_SINGLE_COIL = ModbusRTU::FUNCTION_WRITE_SINGLE_COIL,
+		FUNCTION_WRITE_SINGLE_REGISTER = ModbusRTU::FUNCTION_WRITE_SINGLE_REGISTER,
+		FUNCTION_WRITE_MULTIPLE_COILS = ModbusRTU::FUNCTION_WRITE_MULTIPLE_COILS,
+		FUNCTION_WRITE_MULTIPLE_REGISTERS = ModbusRTU::FUNCTION_WRITE_MULTIPLE_REGISTERS,
+	};
+	enum RequestError {
+		REQUEST_ERROR_TIMEOUT = ModbusRTU::ERROR_TIMEOUT,
+		REQUEST_ERROR_CRC = ModbusRTU::ERROR_CRC,
+		REQUEST_ERROR_MALFORMED = ModbusRTU::ERROR_MALFORMED,
+		REQUEST_ERROR_EXCEPTION = ModbusRTU::ERROR_EXCEPTION,
+		REQUEST_ERROR_IO = ModbusRTU::ERROR_IO,
+	};
+
+private:
+	friend class SerialPort;
+
+	struct Request {
+		int64_t id = 0;
+		ModbusRTU::Request rtu;
+	};
+	struct Result {
+		int64_t id = 0;
+		uint8_t slave_id = 0;
+		Function function = FUNCTION_READ_HOLDING_REGISTERS;
+		uint16_t address = 0;
+		int error = 0;
+		int exception_code = 0;
+		PackedInt32Array values;
+		bool cycle_completed = false;
+	};
+
+	// Attached through SerialPort::modbus_master, which detaches it when the
+	// port is freed, so this never dangles.
+	SerialPort *serial_port = nullptr;
+	ModbusRTU rtu;
+
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable cond;
+	bool should_exit = false;
+	// Polled over and over, every `poll_interval`.
+	std::vector<Request> polls;
+	// One-shot requests, sent before the next poll.
+	std::deque<Request> pending;
+	std::vector<Result> results;
+	std::atomic<bool> results_notify_pending = false;
+	int64_t last_id = 0;
+
+	int response_timeout = 100;
+	int poll_interval = 100;
+	int retries = 0;
+	int turnaround_delay = 100;
+
+	static size_t _port_available(void *p_user_data);
+	static size_t _port_read(void *p_user_data, uint8_t *p_buffer, size_t p_size);
+	static size_t _port_write(void *p_user_data, const uint8_t *p_data, size_t p_size);
+	static void _port_flush_input(void *p_user_data);
+
+	static void _thread_func(void *p_user_data);
+	void _thread_loop();
+	void _update_timing();
+	Result _transact(const Request &request, int timeout, int retry_count, int delay);
+	int64_t _add_request(bool poll, uint8_t slave_id, Function function, uint16_t address, uint16_t count, const std::vector<uint8_t> &payload);
+	void _results_received();
+	// Called by the port being freed.
+	void _detach_serial_port();
+
+public:
+	void set_serial_port(SerialPort *port);
+	SerialPort *get_serial_port() const;
+
+	void set_response_timeout(int msec);
+	int get_response_timeout() const;
+
+	void set_poll_interval(int msec);
+	int get_poll_interval() const;
+
+	void set_retries(int count);
+	int get_retries() const;
+
+	void set_turnaround_delay(int msec);
+	int get_turnaround_delay() const;
+
+	int get_char_time();
+	int get_silent_interval();
+
+	int64_t add_poll(int slave_id, Function function, int address, int count);
+	void remove_poll(int64_t id);
+	void clear_polls();
+
+	int64_t read(int slave_id, Function function, int address, int count);
+	int64_t write_single_coil(int slave_id, int address, bool value);
+	int64_t write_single_register(int slave_id, int address, int value);
+	int64_t write_multiple_coils(int slave_id, int address, const PackedInt32Array &values);
+	int64_t write_multiple_registers(int slave_id, int address, const PackedInt32Array &values);
+
+	Error start();
+	void stop();
+	bool is_running() const;
+
+	ModbusRTUMaster();
+	~ModbusRTUMaster();
+
+protected:
+	static void _bind_methods();
+};
+
+VARIANT_ENUM_CAST(ModbusRTUMaster::Function);
+VARIANT_ENUM_CAST(ModbusRTUMaster::RequestError);
+
+#endif // MODBUS_RTU_MASTER_H
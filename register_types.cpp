@@ -30,7 +30,18 @@
 
 #include "register_types.h"
 
+#include "modbus_rtu_master.h"
 #include "serial_port.h"
+#include "serial_port_manager.h"
+#include "serial_read_request.h"
+
+#ifdef GDEXTENSION
+#include <godot_cpp/classes/engine.hpp>
+#else
+#include "core/config/engine.h"
+#endif
+
+static SerialPortManager *serial_port_manager = nullptr;
 
 void initialize_serial_port_module(ModuleInitializationLevel p_level) {
 	if (p_level != MODULE_INITIALIZATION_LEVEL_SCENE) {
@@ -38,12 +49,30 @@ void initialize_serial_port_module(ModuleInitializationLevel p_level) {
 	}
 
 	GDREGISTER_CLASS(SerialPort);
+	GDREGISTER_CLASS(SerialPortManager);
+	GDREGISTER_CLASS(ModbusRTUMaster);
+	GDREGISTER_CLASS(SerialReadRequest);
+
+	serial_port_manager = memnew(SerialPortManager);
+#ifdef GDEXTENSION
+	Engine::get_singleton()->register_singleton("SerialPortManager", serial_port_manager);
+#else
+	Engine::get_singleton()->add_singleton(Engine::Singleton("SerialPortManager", serial_port_manager));
+#endif
 }
 
 void uninitialize_serial_port_module(ModuleInitializationLevel p_level) {
 	if (p_level != MODULE_INITIALIZATION_LEVEL_SCENE) {
 		return;
 	}
+
+#ifdef GDEXTENSION
+	Engine::get_singleton()->unregister_singleton("SerialPortManager");
+#else
+	Engine::get_singleton()->remove_singleton("SerialPortManager");
+#endif
+	memdelete(serial_port_manager);
+	serial_port_manager = nullptr;
 }
 
 #ifdef GDEXTENSION
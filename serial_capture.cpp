@@ -0,0 +1,257 @@
+/*************************************************************************/
+/*  serial_capture.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "serial_capture.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace std::chrono;
+
+const char SerialCapture::MAGIC[8] = { 'S', 'E', 'R', 'C', 'A', 'P', 'T', '1' };
+
+static_assert(sizeof(SerialCapture::SegmentHeader) == 64, "Segment header layout changed.");
+static_assert(sizeof(SerialCapture::RecordHeader) == 16, "Record header layout changed.");
+
+static inline size_t _align8(size_t size) {
+	return (size + 7) & ~size_t(7);
+}
+
+static inline uint64_t _ticks_usec() {
+	return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+std::string SerialCapture::get_segment_path(const std::string &p_path, uint64_t p_index) {
+	return p_index == 0 ? p_path : p_path + "." + std::to_string(p_index);
+}
+
+// Whether `p_name` is `p_base` followed by a segment suffix, like `.12`.
+static bool _is_segment_name(const std::string &p_name, const std::string &p_base) {
+	if (p_name.size() < p_base.size() + 2 || p_name.compare(0, p_base.size(), p_base) != 0 || p_name[p_base.size()] != '.') {
+		return false;
+	}
+	for (size_t i = p_base.size() + 1; i < p_name.size(); i++) {
+		if (p_name[i] < '0' || p_name[i] > '9') {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Removes the segments after the first of a capture already at `path`. Those
+// left by rotation don't start at `path.1`, so the directory is listed.
+void SerialCapture::_remove_segments() {
+	size_t separator = path.find_last_of("/\\");
+	std::string directory = separator == std::string::npos ? "." : path.substr(0, separator);
+	std::string base = separator == std::string::npos ? path : path.substr(separator + 1);
+
+#ifdef _WIN32
+	WIN32_FIND_DATAA data;
+	HANDLE find = FindFirstFileA((path + ".*").c_str(), &data);
+	if (find == INVALID_HANDLE_VALUE) {
+		return;
+	}
+	do {
+		if (_is_segment_name(data.cFileName, base)) {
+			remove((directory + "/" + data.cFileName).c_str());
+		}
+	} while (FindNextFileA(find, &data));
+	FindClose(find);
+#else
+	DIR *dir = opendir(directory.c_str());
+	if (!dir) {
+		return;
+	}
+	while (struct dirent *entry = readdir(dir)) {
+		if (_is_segment_name(entry->d_name, base)) {
+			remove((directory + "/" + entry->d_name).c_str());
+		}
+	}
+	closedir(dir);
+#endif
+}
+
+bool SerialCapture::_open_segment() {
+	std::string segment_path = get_segment_path(path, segment_index);
+
+#ifdef _WIN32
+	file = CreateFileA(segment_path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		file = nullptr;
+		return false;
+	}
+	mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, DWORD(uint64_t(segment_size) >> 32), DWORD(segment_size & 0xFFFFFFFF), nullptr);
+	map = mapping ? (uint8_t *)MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, segment_size) : nullptr;
+	if (!map) {
+		_close_segment();
+		return false;
+	}
+#else
+	fd = ::open(segment_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (fd < 0) {
+		return false;
+	}
+	// The file stays sparse, pages are only allocated once written.
+	void *addr = ftruncate(fd, segment_size) == 0 ? mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+	if (addr == MAP_FAILED) {
+		_close_segment();
+		return false;
+	}
+	map = (uint8_t *)addr;
+#endif
+	map_size = segment_size;
+
+	SegmentHeader *header = (SegmentHeader *)map;
+	memcpy(header->magic, MAGIC, sizeof(MAGIC));
+	header->version = VERSION;
+	header->header_size = sizeof(SegmentHeader);
+	header->start_unix_usec = start_unix_usec;
+	header->segment_index = segment_index;
+	header->end = sizeof(SegmentHeader);
+	offset = sizeof(SegmentHeader);
+
+	if (max_segments > 0 && segment_index >= max_segments) {
+		remove(get_segment_path(path, segment_index - max_segments).c_str());
+	}
+	return true;
+}
+
+void SerialCapture::_close_segment() {
+#ifdef _WIN32
+	if (map) {
+		UnmapViewOfFile(map);
+	}
+	if (mapping) {
+		CloseHandle(mapping);
+	}
+	if (file) {
+		// Drop the unused tail of the segment.
+		LARGE_INTEGER size;
+		size.QuadPart = map ? offset : 0;
+		SetFilePointerEx(file, size, nullptr, FILE_BEGIN);
+		SetEndOfFile(file);
+		CloseHandle(file);
+	}
+	mapping = nullptr;
+	file = nullptr;
+#else
+	if (map) {
+		munmap(map, map_size);
+	}
+	if (fd >= 0) {
+		// Drop the unused tail of the segment.
+		int err = ftruncate(fd, map ? offset : 0);
+		(void)err;
+		::close(fd);
+	}
+	fd = -1;
+#endif
+	map = nullptr;
+	map_size = 0;
+	offset = 0;
+}
+
+bool SerialCapture::open(const std::string &p_path, size_t p_segment_size, uint32_t p_max_segments) {
+	close();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	path = p_path;
+	// Room for the header and at least one non empty record.
+	segment_size = std::max(_align8(p_segment_size), sizeof(SegmentHeader) + sizeof(RecordHeader) + 8);
+	max_segments = p_max_segments;
+	segment_index = 0;
+	start_unix_usec = duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+	start_ticks = _ticks_usec();
+	_remove_segments();
+	if (!_open_segment()) {
+		return false;
+	}
+	active.store(true, std::memory_order_relaxed);
+	return true;
+}
+
+void SerialCapture::close() {
+	std::lock_guard<std::mutex> lock(mutex);
+	active.store(false, std::memory_order_relaxed);
+	_close_segment();
+}
+
+void SerialCapture::append(Direction p_direction, const uint8_t *p_data, size_t p_size) {
+	if (!active.load(std::memory_order_relaxed) || p_size == 0) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!map) {
+		return;
+	}
+	uint64_t time_usec = _ticks_usec() - start_ticks;
+	while (p_size > 0) {
+		if (offset + sizeof(RecordHeader) + 8 > map_size) {
+			_close_segment();
+			segment_index++;
+			if (!_open_segment()) {
+				active.store(false, std::memory_order_relaxed);
+				return;
+			}
+		}
+
+		size_t size = std::min({ p_size, (map_size - offset - sizeof(RecordHeader)) & ~size_t(7), size_t(UINT32_MAX) });
+		RecordHeader *record = (RecordHeader *)(map + offset);
+		record->time_usec = time_usec;
+		record->size = uint32_t(size);
+		record->direction = uint8_t(p_direction);
+		memset(record->reserved, 0, sizeof(record->reserved));
+		memcpy(map + offset + sizeof(RecordHeader), p_data, size);
+		offset += sizeof(RecordHeader) + _align8(size);
+
+		// Publish the record only once it is complete.
+		std::atomic_thread_fence(std::memory_order_release);
+		((SegmentHeader *)map)->end = offset;
+
+		p_data += size;
+		p_size -= size;
+	}
+}
+
+SerialCapture::~SerialCapture() {
+	close();
+}
@@ -0,0 +1,118 @@
+/*************************************************************************/
+/*  serial_capture.h                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef SERIAL_CAPTURE_H
+#define SERIAL_CAPTURE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// Appends timestamped RX/TX chunks to memory-mapped segment files, so each
+// chunk costs a memcpy and the kernel writes the pages back on its own.
+//
+// A capture is a series of segments named `path`, `path.1`, `path.2`... Each
+// starts with a SegmentHeader followed by records, a RecordHeader and its
+// payload padded to 8 bytes. All values are little-endian. `end` is updated
+// after every record, so a segment left behind by a crash stays readable.
+class SerialCapture {
+public:
+	enum Direction {
+		DIRECTION_RX,
+		DIRECTION_TX,
+	};
+
+	static const uint32_t VERSION = 1;
+
+	struct SegmentHeader {
+		char magic[8];
+		uint32_t version;
+		uint32_t header_size;
+		// Wall clock time the capture started, in microseconds since the epoch.
+		uint64_t start_unix_usec;
+		uint64_t segment_index;
+		// Offset past the last complete record.
+		uint64_t end;
+		uint64_t reserved[3];
+	};
+
+	struct RecordHeader {
+		// Microseconds since the capture started, from a monotonic clock.
+		uint64_t time_usec;
+		uint32_t size;
+		uint8_t direction;
+		uint8_t reserved[3];
+	};
+
+	static const char MAGIC[8];
+
+private:
+	std::mutex mutex;
+	std::atomic<bool> active = false;
+	std::string path;
+	size_t segment_size = 0;
+	uint32_t max_segments = 0;
+	uint64_t segment_index = 0;
+	uint64_t start_unix_usec = 0;
+	uint64_t start_ticks = 0;
+
+	uint8_t *map = nullptr;
+	size_t map_size = 0;
+	size_t offset = 0;
+#ifdef _WIN32
+	void *file = nullptr;
+	void *mapping = nullptr;
+#else
+	int fd = -1;
+#endif
+
+	bool _open_segment();
+	void _close_segment();
+	void _remove_segments();
+
+public:
+	static std::string get_segment_path(const std::string &p_path, uint64_t p_index);
+
+	// Creates the first segment, replacing any capture already at `p_path`
+	// along with all its segments.
+	// With `p_max_segments` > 0 only the most recent segments are kept.
+	bool open(const std::string &p_path, size_t p_segment_size, uint32_t p_max_segments);
+	void close();
+	bool is_open() const { return active.load(std::memory_order_relaxed); }
+
+	// Thread safe. Chunks larger than a segment are split over several records.
+	void append(Direction p_direction, const uint8_t *p_data, size_t p_size);
+
+	~SerialCapture();
+};
+
+#endif // SERIAL_CAPTURE_H
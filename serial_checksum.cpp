@@ -0,0 +1,191 @@
+/*************************************************************************/
+/*  serial_checksum.cpp                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "serial_checksum.h"
+
+#include <cstring>
+
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+// Slice-by-8 tables of a reflected CRC: `table[k][i]` is the CRC of byte `i`
+// followed by `k` zero bytes, so eight bytes are folded with eight lookups.
+struct ReflectedCRCTables {
+	uint32_t table[8][256];
+
+	explicit ReflectedCRCTables(uint32_t reflected_poly) {
+		for (uint32_t i = 0; i < 256; i++) {
+			uint32_t crc = i;
+			for (int bit = 0; bit < 8; bit++) {
+				crc = crc & 1 ? (crc >> 1) ^ reflected_poly : crc >> 1;
+			}
+			table[0][i] = crc;
+		}
+		for (int k = 1; k < 8; k++) {
+			for (uint32_t i = 0; i < 256; i++) {
+				table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xFF];
+			}
+		}
+	}
+
+	// Works for any width up to 32 bits, the unused high bits stay zero.
+	uint32_t update(uint32_t crc, const uint8_t *data, size_t size) const {
+		while (size >= 8) {
+			uint32_t lo, hi;
+			memcpy(&lo, data, 4);
+			memcpy(&hi, data + 4, 4);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+			lo = __builtin_bswap32(lo);
+			hi = __builtin_bswap32(hi);
+#endif
+			lo ^= crc;
+			crc = table[7][lo & 0xFF] ^ table[6][(lo >> 8) & 0xFF] ^ table[5][(lo >> 16) & 0xFF] ^ table[4][lo >> 24] ^
+					table[3][hi & 0xFF] ^ table[2][(hi >> 8) & 0xFF] ^ table[1][(hi >> 16) & 0xFF] ^ table[0][hi >> 24];
+			data += 8;
+			size -= 8;
+		}
+		while (size--) {
+			crc = (crc >> 8) ^ table[0][(crc ^ *data++) & 0xFF];
+		}
+		return crc;
+	}
+};
+
+struct CCITTTable {
+	uint16_t table[256];
+
+	CCITTTable() {
+		for (uint32_t i = 0; i < 256; i++) {
+			uint16_t crc = i << 8;
+			for (int bit = 0; bit < 8; bit++) {
+				crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+			}
+			table[i] = crc;
+		}
+	}
+};
+
+static uint32_t _crc16_modbus(const uint8_t *data, size_t size) {
+	static const ReflectedCRCTables tables(0xA001);
+	return tables.update(0xFFFF, data, size);
+}
+
+static uint32_t _crc16_ccitt(const uint8_t *data, size_t size) {
+	static const CCITTTable ccitt;
+	uint16_t crc = 0xFFFF;
+	for (size_t i = 0; i < size; i++) {
+		crc = (crc << 8) ^ ccitt.table[((crc >> 8) ^ data[i]) & 0xFF];
+	}
+	return crc;
+}
+
+static uint32_t _crc32(const uint8_t *data, size_t size) {
+	uint32_t crc = 0xFFFFFFFF;
+#if defined(__ARM_FEATURE_CRC32)
+	// ARMv8 implements exactly this polynomial in hardware.
+	while (size >= 8) {
+		uint64_t word;
+		memcpy(&word, data, 8);
+		crc = __crc32d(crc, word);
+		data += 8;
+		size -= 8;
+	}
+	while (size--) {
+		crc = __crc32b(crc, *data++);
+	}
+#else
+	static const ReflectedCRCTables tables(0xEDB88320);
+	crc = tables.update(crc, data, size);
+#endif
+	return crc ^ 0xFFFFFFFF;
+}
+
+size_t SerialChecksum::get_size(Type p_type) {
+	switch (p_type) {
+		case TYPE_NONE:
+			return 0;
+		case TYPE_XOR8:
+		case TYPE_SUM8:
+			return 1;
+		case TYPE_CRC16_MODBUS:
+		case TYPE_CRC16_CCITT:
+			return 2;
+		case TYPE_CRC32:
+			return 4;
+	}
+	return 0;
+}
+
+uint32_t SerialChecksum::compute(Type p_type, const uint8_t *data, size_t size) {
+	switch (p_type) {
+		case TYPE_NONE:
+			return 0;
+		case TYPE_XOR8: {
+			uint8_t value = 0;
+			for (size_t i = 0; i < size; i++) {
+				value ^= data[i];
+			}
+			return value;
+		}
+		case TYPE_SUM8: {
+			uint8_t value = 0;
+			for (size_t i = 0; i < size; i++) {
+				value += data[i];
+			}
+			return value;
+		}
+		case TYPE_CRC16_MODBUS:
+			return _crc16_modbus(data, size);
+		case TYPE_CRC16_CCITT:
+			return _crc16_ccitt(data, size);
+		case TYPE_CRC32:
+			return _crc32(data, size);
+	}
+	return 0;
+}
+
+void SerialChecksum::encode(Type p_type, uint32_t value, bool big_endian, uint8_t *r_bytes) {
+	size_t size = get_size(p_type);
+	for (size_t i = 0; i < size; i++) {
+		size_t shift = 8 * (big_endian ? size - 1 - i : i);
+		r_bytes[i] = (value >> shift) & 0xFF;
+	}
+}
+
+bool SerialChecksum::verify(Type p_type, const uint8_t *frame, size_t size, bool big_endian) {
+	size_t checksum_size = get_size(p_type);
+	if (size < checksum_size) {
+		return false;
+	}
+	uint8_t expected[4];
+	encode(p_type, compute(p_type, frame, size - checksum_size), big_endian, expected);
+	return memcmp(expected, frame + size - checksum_size, checksum_size) == 0;
+}
@@ -0,0 +1,62 @@
+/*************************************************************************/
+/*  serial_checksum.h                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef SERIAL_CHECKSUM_H
+#define SERIAL_CHECKSUM_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Checksums appended to frames by common serial protocols.
+class SerialChecksum {
+public:
+	enum Type {
+		TYPE_NONE,
+		TYPE_XOR8,
+		TYPE_SUM8,
+		// Reflected 0x8005, init 0xFFFF.
+		TYPE_CRC16_MODBUS,
+		// 0x1021, init 0xFFFF, a.k.a. CRC-16/CCITT-FALSE.
+		TYPE_CRC16_CCITT,
+		// Reflected 0x04C11DB7 as used by Ethernet and zlib.
+		TYPE_CRC32,
+	};
+
+	static size_t get_size(Type p_type);
+	static uint32_t compute(Type p_type, const uint8_t *data, size_t size);
+
+	// Stores `value` in get_size() bytes at `r_bytes`.
+	static void encode(Type p_type, uint32_t value, bool big_endian, uint8_t *r_bytes);
+
+	// Checks the checksum stored in the last get_size() bytes of `frame`.
+	static bool verify(Type p_type, const uint8_t *frame, size_t size, bool big_endian);
+};
+
+#endif // SERIAL_CHECKSUM_H
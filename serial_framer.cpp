@@ -0,0 +1,289 @@
+/*************************************************************************/
+/*  serial_framer.cpp                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "serial_framer.h"
+
+#include <cstring>
+
+static const uint8_t SLIP_END = 0xC0;
+static const uint8_t SLIP_ESC = 0xDB;
+static const uint8_t SLIP_ESC_END = 0xDC;
+static const uint8_t SLIP_ESC_ESC = 0xDD;
+
+void SerialFramer::set_mode(Mode p_mode) {
+	mode = p_mode;
+	reset();
+}
+
+void SerialFramer::set_delimiter(const uint8_t *p_delimiter, size_t p_size) {
+	delimiter.assign(p_delimiter, p_delimiter + p_size);
+	reset();
+}
+
+void SerialFramer::set_frame_length(size_t p_length) {
+	frame_length = p_length > 0 ? p_length : 1;
+	reset();
+}
+
+void SerialFramer::set_length_field(size_t p_offset, size_t p_size, bool p_big_endian, int64_t p_adjustment) {
+	length_field_offset = p_offset;
+	length_field_size = p_size > 0 && p_size <= 8 ? p_size : 1;
+	length_field_big_endian = p_big_endian;
+	length_adjustment = p_adjustment;
+	reset();
+}
+
+void SerialFramer::set_max_frame_size(size_t p_size) {
+	max_frame_size = p_size;
+	reset();
+}
+
+void SerialFramer::reset() {
+	pending.clear();
+	frame.clear();
+	escaping = false;
+	discarding = false;
+}
+
+void SerialFramer::_drop_frame() {
+	frame.clear();
+	escaping = false;
+	dropped_frames++;
+}
+
+void SerialFramer::feed(const uint8_t *data, size_t size, FrameCallback callback, void *user_data) {
+	switch (mode) {
+		case MODE_NONE:
+			callback(user_data, data, size);
+			break;
+		case MODE_DELIMITER:
+			_feed_delimiter(data, size, callback, user_data);
+			break;
+		case MODE_FIXED_LENGTH:
+			_feed_fixed_length(data, size, callback, user_data);
+			break;
+		case MODE_LENGTH_PREFIX:
+			_feed_length_prefix(data, size, callback, user_data);
+			break;
+		case MODE_SLIP:
+			_feed_slip(data, size, callback, user_data);
+			break;
+		case MODE_COBS:
+			_feed_cobs(data, size, callback, user_data);
+			break;
+	}
+}
+
+void SerialFramer::_feed_delimiter(const uint8_t *data, size_t size, FrameCallback callback, void *user_data) {
+	if (delimiter.empty()) {
+		callback(user_data, data, size);
+		return;
+	}
+
+	// A delimiter may straddle two chunks, so rescan the tail of what is pending.
+	size_t scan_from = pending.size() >= delimiter.size() ? pending.size() - delimiter.size() + 1 : 0;
+	pending.insert(pending.end(), data, data + size);
+
+	const uint8_t *buf = pending.data();
+	size_t consumed = 0;
+	size_t pos = scan_from;
+	while (pos + delimiter.size() <= pending.size()) {
+		const uint8_t *hit = static_cast<const uint8_t *>(memchr(buf + pos, delimiter[0], pending.size() - pos - delimiter.size() + 1));
+		if (!hit) {
+			break;
+		}
+		pos = hit - buf;
+		if (memcmp(hit, delimiter.data(), delimiter.size()) != 0) {
+			pos++;
+			continue;
+		}
+		if (discarding) {
+			discarding = false;
+		} else if (max_frame_size > 0 && pos - consumed > max_frame_size) {
+			dropped_frames++;
+		} else {
+			callback(user_data, buf + consumed, pos - consumed);
+		}
+		pos += delimiter.size();
+		consumed = pos;
+	}
+
+	pending.erase(pending.begin(), pending.begin() + consumed);
+	if (max_frame_size > 0 && pending.size() > max_frame_size + delimiter.size()) {
+		// Too long already, skip everything up to the next delimiter.
+		if (!discarding) {
+			dropped_frames++;
+			discarding = true;
+		}
+		pending.erase(pending.begin(), pending.end() - (delimiter.size() - 1));
+	}
+}
+
+void SerialFramer::_feed_fixed_length(const uint8_t *data, size_t size, FrameCallback callback, void *user_data) {
+	if (!pending.empty()) {
+		size_t needed = frame_length - pending.size();
+		size_t take = needed < size ? needed : size;
+		pending.insert(pending.end(), data, data + take);
+		data += take;
+		size -= take;
+		if (pending.size() < frame_length) {
+			return;
+		}
+		callback(user_data, pending.data(), frame_length);
+		pending.clear();
+	}
+
+	// Whole frames are handed out straight from the input.
+	while (size >= frame_length) {
+		callback(user_data, data, frame_length);
+		data += frame_length;
+		size -= frame_length;
+	}
+	pending.assign(data, data + size);
+}
+
+void SerialFramer::_feed_length_prefix(const uint8_t *data, size_t size, FrameCallback callback, void *user_data) {
+	pending.insert(pending.end(), data, data + size);
+
+	size_t header_size = length_field_offset + length_field_size;
+	size_t consumed = 0;
+	while (pending.size() - consumed >= header_size) {
+		const uint8_t *field = pending.data() + consumed + length_field_offset;
+		uint64_t value = 0;
+		for (size_t i = 0; i < length_field_size; i++) {
+			uint8_t byte = length_field_big_endian ? field[i] : field[length_field_size - 1 - i];
+			value = (value << 8) | byte;
+		}
+
+		int64_t total = int64_t(header_size) + int64_t(value) + length_adjustment;
+		if (total < int64_t(header_size) || (max_frame_size > 0 && total > int64_t(max_frame_size))) {
+			// Garbage length, slide by one byte to find the next plausible header.
+			dropped_frames++;
+			consumed++;
+			continue;
+		}
+		if (pending.size() - consumed < size_t(total)) {
+			break;
+		}
+		callback(user_data, pending.data() + consumed, total);
+		consumed += total;
+	}
+
+	pending.erase(pending.begin(), pending.begin() + consumed);
+}
+
+void SerialFramer::_feed_slip(const uint8_t *data, size_t size, FrameCallback callback, void *user_data) {
+	for (size_t i = 0; i < size; i++) {
+		uint8_t byte = data[i];
+		if (byte == SLIP_END) {
+			if (discarding) {
+				discarding = false;
+			} else if (!frame.empty()) {
+				callback(user_data, frame.data(), frame.size());
+			}
+			frame.clear();
+			escaping = false;
+			continue;
+		}
+		if (discarding) {
+			continue;
+		}
+		if (escaping) {
+			escaping = false;
+			if (byte == SLIP_ESC_END) {
+				byte = SLIP_END;
+			} else if (byte == SLIP_ESC_ESC) {
+				byte = SLIP_ESC;
+			} else {
+				_drop_frame();
+				discarding = true;
+				continue;
+			}
+		} else if (byte == SLIP_ESC) {
+			escaping = true;
+			continue;
+		}
+		if (max_frame_size > 0 && frame.size() >= max_frame_size) {
+			_drop_frame();
+			discarding = true;
+			continue;
+		}
+		frame.push_back(byte);
+	}
+}
+
+void SerialFramer::_feed_cobs(const uint8_t *data, size_t size, FrameCallback callback, void *user_data) {
+	for (size_t i = 0; i < size; i++) {
+		uint8_t byte = data[i];
+		if (byte != 0) {
+			if (discarding) {
+				continue;
+			}
+			// Bounds the encoded frame, which is never shorter than the decoded one.
+			if (max_frame_size > 0 && pending.size() >= max_frame_size) {
+				pending.clear();
+				dropped_frames++;
+				discarding = true;
+				continue;
+			}
+			pending.push_back(byte);
+			continue;
+		}
+
+		// A zero byte ends the encoded frame, decode it as a whole.
+		if (discarding || pending.empty()) {
+			discarding = false;
+			pending.clear();
+			continue;
+		}
+		frame.clear();
+		size_t pos = 0;
+		bool valid = true;
+		while (pos < pending.size()) {
+			uint8_t code = pending[pos++];
+			if (pos + code - 1 > pending.size()) {
+				valid = false;
+				break;
+			}
+			frame.insert(frame.end(), pending.begin() + pos, pending.begin() + pos + code - 1);
+			pos += code - 1;
+			if (code < 0xFF && pos < pending.size()) {
+				frame.push_back(0);
+			}
+		}
+		if (valid) {
+			callback(user_data, frame.data(), frame.size());
+		} else {
+			dropped_frames++;
+		}
+		pending.clear();
+		frame.clear();
+	}
+}
@@ -0,0 +1,106 @@
+/*************************************************************************/
+/*  serial_framer.h                                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef SERIAL_FRAMER_H
+#define SERIAL_FRAMER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Splits a received byte stream into packets. Bytes may be fed in chunks of
+// any size, partial frames are kept until the rest arrives.
+class SerialFramer {
+public:
+	enum Mode {
+		MODE_NONE,
+		MODE_DELIMITER,
+		MODE_FIXED_LENGTH,
+		MODE_LENGTH_PREFIX,
+		MODE_SLIP,
+		MODE_COBS,
+	};
+
+	typedef void (*FrameCallback)(void *p_user_data, const uint8_t *p_frame, size_t p_size);
+
+private:
+	Mode mode = MODE_NONE;
+	std::vector<uint8_t> delimiter = { '\n' };
+	size_t frame_length = 1;
+	size_t length_field_offset = 0;
+	size_t length_field_size = 1;
+	bool length_field_big_endian = false;
+	int64_t length_adjustment = 0;
+	size_t max_frame_size = 4096;
+
+	std::vector<uint8_t> pending;
+	std::vector<uint8_t> frame;
+	bool escaping = false;
+	bool discarding = false;
+	uint64_t dropped_frames = 0;
+
+	void _feed_delimiter(const uint8_t *data, size_t size, FrameCallback callback, void *user_data);
+	void _feed_fixed_length(const uint8_t *data, size_t size, FrameCallback callback, void *user_data);
+	void _feed_length_prefix(const uint8_t *data, size_t size, FrameCallback callback, void *user_data);
+	void _feed_slip(const uint8_t *data, size_t size, FrameCallback callback, void *user_data);
+	void _feed_cobs(const uint8_t *data, size_t size, FrameCallback callback, void *user_data);
+	void _drop_frame();
+
+public:
+	void set_mode(Mode p_mode);
+	Mode get_mode() const { return mode; }
+
+	void set_delimiter(const uint8_t *p_delimiter, size_t p_size);
+	const std::vector<uint8_t> &get_delimiter() const { return delimiter; }
+
+	void set_frame_length(size_t p_length);
+	size_t get_frame_length() const { return frame_length; }
+
+	// Length prefixed frames: the frame is `length_field_offset` header bytes,
+	// the length field itself, then `value + length_adjustment` more bytes.
+	void set_length_field(size_t p_offset, size_t p_size, bool p_big_endian, int64_t p_adjustment);
+	size_t get_length_field_offset() const { return length_field_offset; }
+	size_t get_length_field_size() const { return length_field_size; }
+	bool is_length_field_big_endian() const { return length_field_big_endian; }
+	int64_t get_length_adjustment() const { return length_adjustment; }
+
+	void set_max_frame_size(size_t p_size);
+	size_t get_max_frame_size() const { return max_frame_size; }
+
+	uint64_t get_dropped_frames() const { return dropped_frames; }
+
+	// Forgets any partially received frame.
+	void reset();
+
+	// Calls `callback` once for every frame completed by `data`.
+	void feed(const uint8_t *data, size_t size, FrameCallback callback, void *user_data);
+};
+
+#endif // SERIAL_FRAMER_H
@@ -0,0 +1,54 @@
+/*************************************************************************/
+/*  serial_line_reader.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "serial_line_reader.h"
+
+// memchr() is vectorized by the C library, so only candidate first bytes are
+// compared in full.
+size_t SerialLineReader::find(const uint8_t *p_data, size_t p_size, const uint8_t *p_delimiter, size_t p_delimiter_size) {
+	size_t pos = 0;
+	while (pos + p_delimiter_size <= p_size) {
+		const uint8_t *hit = static_cast<const uint8_t *>(memchr(p_data + pos, p_delimiter[0], p_size - pos - p_delimiter_size + 1));
+		if (!hit) {
+			break;
+		}
+		pos = hit - p_data;
+		if (memcmp(hit, p_delimiter, p_delimiter_size) == 0) {
+			return pos;
+		}
+		pos++;
+	}
+	return p_size;
+}
+
+void SerialLineReader::clear() {
+	buffer.clear();
+	start = 0;
+}
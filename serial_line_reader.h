@@ -0,0 +1,120 @@
+/*************************************************************************/
+/*  serial_line_reader.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef SERIAL_LINE_READER_H
+#define SERIAL_LINE_READER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Read-ahead of SerialPort.read_line(): reads take whatever the port already
+// has in one call and lines are cut out of the buffer, so a line costs one
+// read instead of one per byte. The other reads consume it first. The port is
+// passed in as `p_available()` and `p_read(buffer, size)`, the latter blocking
+// up to the port's timeout. Not thread-safe, the owner serializes access.
+class SerialLineReader {
+	// Largest single read filling the buffer.
+	static const size_t MAX_READ = 65536;
+
+	std::vector<uint8_t> buffer;
+	size_t start = 0;
+
+	template <typename Available, typename Read>
+	bool _fill(Available p_available, Read p_read) {
+		if (start == buffer.size()) {
+			buffer.clear();
+			start = 0;
+		} else if (start > buffer.size() / 2) {
+			buffer.erase(buffer.begin(), buffer.begin() + start);
+			start = 0;
+		}
+
+		// Take everything the port already has in one call, or block for a
+		// single byte up to the timeout when it has nothing.
+		size_t size = std::min(std::max(p_available(), size_t(1)), MAX_READ);
+		size_t buffered = buffer.size();
+		buffer.resize(buffered + size);
+		size_t bytes_read = p_read(buffer.data() + buffered, size);
+		buffer.resize(buffered + bytes_read);
+		return bytes_read > 0;
+	}
+
+public:
+	// Position of `p_delimiter` in `p_data`, or `p_size` if absent.
+	static size_t find(const uint8_t *p_data, size_t p_size, const uint8_t *p_delimiter, size_t p_delimiter_size);
+
+	size_t get_buffered() const { return buffer.size() - start; }
+	const uint8_t *get_data() const { return buffer.data() + start; }
+	void consume(size_t p_size) { start += p_size; }
+	void clear();
+
+	// Copies what is buffered, then reads the rest from the port.
+	template <typename Read>
+	size_t read(uint8_t *p_buffer, size_t p_size, Read p_read) {
+		size_t buffered = std::min(p_size, get_buffered());
+		if (buffered > 0) {
+			memcpy(p_buffer, get_data(), buffered);
+			start += buffered;
+		}
+		if (buffered == p_size) {
+			return p_size;
+		}
+		return buffered + p_read(p_buffer + buffered, p_size - buffered);
+	}
+
+	// Reads until a line ending with `p_eol` is buffered, `p_max_length` bytes
+	// are, or a read times out. Returns the length of the line at get_data(),
+	// `p_eol` included; consume() it once done.
+	template <typename Available, typename Read>
+	size_t buffer_line(size_t p_max_length, const uint8_t *p_eol, size_t p_eol_size, Available p_available, Read p_read) {
+		size_t scanned = 0;
+		while (true) {
+			const uint8_t *data = get_data();
+			size_t buffered = std::min(get_buffered(), p_max_length);
+			if (p_eol_size > 0) {
+				// Only rescan the tail that may hold an eol cut by the last read.
+				size_t from = scanned >= p_eol_size ? scanned - p_eol_size + 1 : 0;
+				size_t pos = from + find(data + from, buffered - from, p_eol, p_eol_size);
+				if (pos < buffered) {
+					return pos + p_eol_size;
+				}
+			}
+			if (buffered == p_max_length || !_fill(p_available, p_read)) {
+				return buffered;
+			}
+			scanned = buffered;
+		}
+	}
+};
+
+#endif // SERIAL_LINE_READER_H
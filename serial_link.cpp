@@ -0,0 +1,208 @@
+/*************************************************************************/
+/*  serial_link.cpp                                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "serial_link.h"
+
+#include <chrono>
+#include <cstring>
+
+#ifdef SERIAL_PORT_EVENT_MONITOR
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+using namespace std::chrono;
+
+static inline uint64_t _ticks_usec() {
+	return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+bool SerialLink::unblock_receive() {
+	if (!receive_blocked.exchange(false)) {
+		return false;
+	}
+	wakeup();
+	return true;
+}
+
+bool SerialLink::start_monitoring(MonitorMode p_mode, int p_interval_usec, const Callbacks &p_callbacks) {
+	stop_monitoring();
+	mode = p_mode;
+	interval_usec = p_interval_usec;
+	callbacks = p_callbacks;
+#ifdef SERIAL_PORT_EVENT_MONITOR
+	if (mode == MONITOR_EVENT_DRIVEN) {
+		if (pipe(wakeup_fds) != 0) {
+			return false;
+		}
+		fcntl(wakeup_fds[0], F_SETFL, fcntl(wakeup_fds[0], F_GETFL) | O_NONBLOCK);
+		fcntl(wakeup_fds[1], F_SETFL, fcntl(wakeup_fds[1], F_GETFL) | O_NONBLOCK);
+	}
+#endif
+	should_exit = false;
+	thread = std::thread(_thread_func, this);
+	return true;
+}
+
+void SerialLink::stop_monitoring() {
+	should_exit = true;
+	wakeup();
+	if (thread.joinable()) {
+		thread.join();
+	}
+#ifdef SERIAL_PORT_EVENT_MONITOR
+	for (int &fd : wakeup_fds) {
+		if (fd >= 0) {
+			::close(fd);
+			fd = -1;
+		}
+	}
+#endif
+}
+
+void SerialLink::wakeup() {
+#ifdef SERIAL_PORT_EVENT_MONITOR
+	if (wakeup_fds[1] >= 0) {
+		const uint8_t token = 0;
+		// The pipe is non-blocking, a full pipe already means a pending wakeup.
+		(void)!::write(wakeup_fds[1], &token, 1);
+	}
+#endif
+}
+
+void SerialLink::_thread_func(void *p_user_data) {
+	SerialLink *link = static_cast<SerialLink *>(p_user_data);
+#ifdef SERIAL_PORT_EVENT_MONITOR
+	if (link->mode == MONITOR_EVENT_DRIVEN) {
+		link->_event_loop();
+		return;
+	}
+#endif
+	link->_polling_loop();
+}
+
+void SerialLink::_polling_loop() {
+	while (!should_exit) {
+		uint64_t time_start = _ticks_usec();
+		SerialPortStats::add(stats->monitor_wakeups);
+
+		if (is_open() && callbacks.can_read(callbacks.user_data)) {
+			callbacks.receive(callbacks.user_data, 0);
+		}
+		uint64_t time_elapsed = _ticks_usec() - time_start;
+		if (time_elapsed < uint64_t(interval_usec)) {
+			std::this_thread::sleep_for(microseconds(interval_usec - time_elapsed));
+		}
+	}
+}
+
+#ifdef SERIAL_PORT_EVENT_MONITOR
+void SerialLink::_event_loop() {
+	int rx_fd = -1;
+	uint64_t last_delivery = 0;
+
+	while (!should_exit) {
+		if (rx_fd < 0 && is_open() && callbacks.can_read(callbacks.user_data)) {
+			rx_fd = callbacks.open_fd(callbacks.user_data);
+		} else if (rx_fd >= 0 && !(receiving && is_open())) {
+			::close(rx_fd);
+			rx_fd = -1;
+		}
+
+		struct pollfd fds[2] = {
+			{ wakeup_fds[0], POLLIN, 0 },
+			{ rx_fd, POLLIN, 0 },
+		};
+		// Without a port, or with a full receive buffer, there is nothing to wait
+		// for but a wakeup.
+		bool poll_rx = rx_fd >= 0 && !receive_blocked;
+		// A port backing off is tried again once its delay is over.
+		int64_t retry_delay = callbacks.get_retry_delay(callbacks.user_data);
+		int timeout = rx_fd < 0 && retry_delay >= 0 ? int((retry_delay + 999) / 1000) : -1;
+		if (::poll(fds, poll_rx ? 2 : 1, timeout) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			// Polling still works without waiting on the descriptors.
+			callbacks.on_error(callbacks.user_data, __FUNCTION__, strerror(errno));
+			break;
+		}
+		SerialPortStats::add(stats->monitor_wakeups);
+
+		if (fds[0].revents & POLLIN) {
+			uint8_t tokens[64];
+			while (::read(wakeup_fds[0], tokens, sizeof(tokens)) > 0) {
+			}
+		}
+		if (!poll_rx || should_exit) {
+			continue;
+		}
+		if (fds[1].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+			::close(rx_fd);
+			rx_fd = -1;
+			callbacks.on_error(callbacks.user_data, __FUNCTION__, "Port hung up.");
+			continue;
+		}
+		if (!(fds[1].revents & POLLIN)) {
+			continue;
+		}
+		uint64_t readable_at = _ticks_usec();
+
+		// The interval only coalesces bursts: the first byte after a quiet
+		// period is delivered at once, later ones at most once per interval.
+		uint64_t time_elapsed = readable_at - last_delivery;
+		if (time_elapsed < uint64_t(interval_usec)) {
+			struct pollfd wakeup = { wakeup_fds[0], POLLIN, 0 };
+			::poll(&wakeup, 1, int((interval_usec - time_elapsed + 999) / 1000));
+			if (should_exit) {
+				break;
+			}
+		}
+
+		if (receiving && is_open()) {
+			callbacks.receive(callbacks.user_data, readable_at);
+		}
+		last_delivery = _ticks_usec();
+	}
+
+	if (rx_fd >= 0) {
+		::close(rx_fd);
+	}
+	if (!should_exit) {
+		_polling_loop();
+	}
+}
+#endif
+
+SerialLink::~SerialLink() {
+	stop_monitoring();
+}
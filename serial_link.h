@@ -0,0 +1,203 @@
+/*************************************************************************/
+/*  serial_link.h                                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef SERIAL_LINK_H
+#define SERIAL_LINK_H
+
+#include "serial_port_lock.h"
+#include "serial_port_stats.h"
+#include "spsc_ring_buffer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+
+#ifndef _WIN32
+// Platforms where the monitor can block on the port descriptor with poll().
+#define SERIAL_PORT_EVENT_MONITOR
+#endif
+
+// The locking and the monitor thread at the core of a SerialPort, std-only so
+// the benchmark's stress test runs the same code. The port itself stays with
+// the owner, which passes its calls in.
+//
+// Reads (monitor or caller) and writes (caller or writer thread) go through
+// io() and hold the lock shared, so they run in parallel on the read and write
+// locks serial::Serial has of its own. open(), close() and settings changes
+// hold it exclusively, so they wait for the calls in flight and the monitor
+// never sees a port half reconfigured; a waiting exclusive locker goes ahead
+// of new reads and writes. close() first stops the monitor from starting new
+// reads, then waits for the one in flight.
+class SerialLink {
+public:
+	enum MonitorMode {
+		MONITOR_POLLING,
+		// Blocks in poll() until the port is readable, polling where it can't.
+		MONITOR_EVENT_DRIVEN,
+	};
+
+	struct Callbacks {
+		void *user_data = nullptr;
+		// Whether the monitor may read now. It may let a port backing off after
+		// errors probe once more.
+		bool (*can_read)(void *p_user_data) = nullptr;
+		// Microseconds until a port backing off may be read again, -1 if it isn't.
+		int64_t (*get_retry_delay)(void *p_user_data) = nullptr;
+		// A descriptor readable whenever the port is, -1 on failure.
+		int (*open_fd)(void *p_user_data) = nullptr;
+		// Reads what the port has. `p_readable_at` is when poll() saw it, 0 if
+		// the monitor is polling.
+		void (*receive)(void *p_user_data, uint64_t p_readable_at) = nullptr;
+		void (*on_error)(void *p_user_data, const char *p_where, const char *p_what) = nullptr;
+	};
+
+private:
+	mutable SerialPortLock config_mutex;
+	std::atomic<bool> port_open = false;
+	std::atomic<bool> receiving = false;
+	std::atomic<bool> receive_blocked = false;
+	SerialPortStats *stats;
+
+	MonitorMode mode = MONITOR_EVENT_DRIVEN;
+	int interval_usec = 10000;
+	Callbacks callbacks;
+	std::atomic<bool> should_exit = true;
+	std::thread thread;
+#ifdef SERIAL_PORT_EVENT_MONITOR
+	// Self-pipe used to interrupt the monitor thread while it blocks in poll().
+	int wakeup_fds[2] = { -1, -1 };
+#endif
+
+	static void _thread_func(void *p_user_data);
+	void _polling_loop();
+#ifdef SERIAL_PORT_EVENT_MONITOR
+	void _event_loop();
+#endif
+
+public:
+	// The lock settings changes hold exclusively, and queries shared.
+	SerialPortLock &get_lock() const { return config_mutex; }
+	bool is_open() const { return port_open; }
+
+	// Opens the port with `p_open()`, which returns false if it failed, while
+	// holding the lock exclusively. Exceptions are left to the caller.
+	template <typename F>
+	bool open(F p_open) {
+		std::unique_lock<SerialPortLock> lock(config_mutex);
+		if (!p_open()) {
+			return false;
+		}
+		port_open = true;
+		receiving = true;
+		wakeup();
+		return true;
+	}
+
+	// Closes the port with `p_close()` once the read in flight has returned.
+	// The port counts as closed even if `p_close()` throws.
+	template <typename F>
+	void close(F p_close) {
+		receiving = false;
+		std::unique_lock<SerialPortLock> lock(config_mutex);
+		port_open = false;
+		wakeup();
+		p_close();
+	}
+
+	// Runs the read or write `p_io()` holding the lock shared, returns 0
+	// without calling it if close() won the race for the lock.
+	template <typename F>
+	size_t io(F p_io) const {
+		std::shared_lock<SerialPortLock> lock(config_mutex);
+		if (!port_open) {
+			return 0;
+		}
+		return p_io();
+	}
+
+	// Cleared while the owner backs off from a failing port, the monitor leaves
+	// it alone until `can_read` lets it probe again.
+	bool is_receiving() const { return receiving; }
+	void set_receiving(bool p_receiving) { receiving = p_receiving; }
+
+	// Set while the owner's receive buffer is full, the monitor stops waiting
+	// for data there is no room for. unblock_receive() returns whether it was.
+	bool is_receive_blocked() const { return receive_blocked; }
+	bool unblock_receive();
+
+	// Reads up to `p_size` bytes with `p_read(buffer, size)` straight into the
+	// free spans of `p_ring`, the receive buffer the owner drains. Runs
+	// `p_on_read(size)` before each read is published, and stops blocked once
+	// the ring is full.
+	template <typename Read, typename OnRead>
+	size_t receive_into(SPSCRingBuffer &p_ring, size_t p_size, Read p_read, OnRead p_on_read) {
+		size_t received = 0;
+		while (received < p_size) {
+			uint8_t *span;
+			size_t span_size = p_ring.get_write_span(&span);
+			if (span_size == 0) {
+				receive_blocked = true;
+				// The consumer may have drained the ring before it could see the flag.
+				if (p_ring.space() == 0) {
+					break;
+				}
+				receive_blocked = false;
+				continue;
+			}
+
+			size_t bytes_read = p_read(span, std::min(span_size, p_size - received));
+			if (bytes_read == 0) {
+				break;
+			}
+			p_on_read(bytes_read);
+			p_ring.commit_write(bytes_read);
+			received += bytes_read;
+		}
+		return received;
+	}
+
+	// `p_interval_usec` is the polling period, or how long the event-driven
+	// monitor coalesces bursts for.
+	bool start_monitoring(MonitorMode p_mode, int p_interval_usec, const Callbacks &p_callbacks);
+	void stop_monitoring();
+	bool is_monitoring() const { return thread.joinable(); }
+	// Has the monitor look at the port again, e.g. after open() or close().
+	void wakeup();
+
+	explicit SerialLink(SerialPortStats &p_stats) :
+			stats(&p_stats) {}
+	~SerialLink();
+};
+
+#endif // SERIAL_LINK_H
@@ -0,0 +1,157 @@
+/*************************************************************************/
+/*  serial_low_latency.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "serial_low_latency.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/serial.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#endif
+
+std::string SerialLowLatency::_latency_timer_path(const std::string &p_port) {
+#ifdef __linux__
+	// Resolves aliases like /dev/serial/by-id/... to the ttyUSB node.
+	char resolved[PATH_MAX];
+	if (!realpath(p_port.c_str(), resolved)) {
+		return std::string();
+	}
+	std::string name = resolved;
+	name = name.substr(name.find_last_of('/') + 1);
+	return "/sys/bus/usb-serial/devices/" + name + "/latency_timer";
+#else
+	return std::string();
+#endif
+}
+
+#ifdef __linux__
+static int _read_latency_timer(const std::string &p_path) {
+	FILE *file = fopen(p_path.c_str(), "r");
+	if (!file) {
+		return -1;
+	}
+	int value = -1;
+	if (fscanf(file, "%d", &value) != 1) {
+		value = -1;
+	}
+	fclose(file);
+	return value;
+}
+
+static bool _write_latency_timer(const std::string &p_path, int p_value) {
+	FILE *file = fopen(p_path.c_str(), "w");
+	if (!file) {
+		return false;
+	}
+	bool ok = fprintf(file, "%d", p_value) > 0;
+	return fclose(file) == 0 && ok;
+}
+#endif
+
+const SerialLowLatency::Status &SerialLowLatency::enable(const std::string &p_port) {
+	status = Status();
+#ifdef __linux__
+	int fd = ::open(p_port.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+	if (fd < 0) {
+		return status;
+	}
+
+	struct serial_struct serial_info;
+	if (ioctl(fd, TIOCGSERIAL, &serial_info) == 0) {
+		if (!enabled) {
+			saved_async_low_latency = serial_info.flags & ASYNC_LOW_LATENCY;
+		}
+		serial_info.flags |= ASYNC_LOW_LATENCY;
+		status.async_low_latency = ioctl(fd, TIOCSSERIAL, &serial_info) == 0 && ioctl(fd, TIOCGSERIAL, &serial_info) == 0 &&
+				(serial_info.flags & ASYNC_LOW_LATENCY);
+	}
+
+	// serial::Serial waits with select() before reading, any VMIN or VTIME
+	// would only delay read() or make it block past the timeout.
+	struct termios options;
+	if (tcgetattr(fd, &options) == 0) {
+		if (options.c_cc[VMIN] != 0 || options.c_cc[VTIME] != 0) {
+			options.c_cc[VMIN] = 0;
+			options.c_cc[VTIME] = 0;
+			tcsetattr(fd, TCSANOW, &options);
+			tcgetattr(fd, &options);
+		}
+		status.vmin_vtime = options.c_cc[VMIN] == 0 && options.c_cc[VTIME] == 0;
+	}
+	::close(fd);
+
+	std::string timer_path = _latency_timer_path(p_port);
+	int latency_timer = timer_path.empty() ? -1 : _read_latency_timer(timer_path);
+	if (latency_timer >= 0) {
+		if (!enabled) {
+			saved_latency_timer = latency_timer;
+		}
+		// Writable by root only on most systems, report what is really set.
+		if (latency_timer > 1 && _write_latency_timer(timer_path, 1)) {
+			latency_timer = _read_latency_timer(timer_path);
+		}
+		status.latency_timer = latency_timer;
+	}
+#endif
+	enabled = true;
+	return status;
+}
+
+void SerialLowLatency::disable(const std::string &p_port) {
+	if (!enabled) {
+		return;
+	}
+	enabled = false;
+#ifdef __linux__
+	int fd = ::open(p_port.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+	if (fd >= 0) {
+		struct serial_struct serial_info;
+		if (status.async_low_latency && !saved_async_low_latency && ioctl(fd, TIOCGSERIAL, &serial_info) == 0) {
+			serial_info.flags &= ~ASYNC_LOW_LATENCY;
+			ioctl(fd, TIOCSSERIAL, &serial_info);
+		}
+		::close(fd);
+	}
+	if (saved_latency_timer > 1 && status.latency_timer != saved_latency_timer) {
+		std::string timer_path = _latency_timer_path(p_port);
+		if (!timer_path.empty()) {
+			_write_latency_timer(timer_path, saved_latency_timer);
+		}
+	}
+#endif
+	saved_latency_timer = -1;
+	status = Status();
+}
@@ -0,0 +1,68 @@
+/*************************************************************************/
+/*  serial_low_latency.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef SERIAL_LOW_LATENCY_H
+#define SERIAL_LOW_LATENCY_H
+
+#include <string>
+
+// Driver settings trading CPU time for receive latency, Linux only. They are
+// set through descriptors of their own, so any open tty path works.
+class SerialLowLatency {
+public:
+	struct Status {
+		// TIOCSSERIAL ASYNC_LOW_LATENCY, makes the driver push received data
+		// to the tty layer at once instead of from a deferred work queue.
+		bool async_low_latency = false;
+		// VMIN 0 and VTIME 0, so read() returns whatever is buffered at once.
+		bool vmin_vtime = false;
+		// FTDI latency timer in milliseconds, -1 if the adapter has none.
+		int latency_timer = -1;
+	};
+
+private:
+	bool enabled = false;
+	bool saved_async_low_latency = false;
+	int saved_latency_timer = -1;
+	Status status;
+
+	static std::string _latency_timer_path(const std::string &p_port);
+
+public:
+	// Applies every setting it can and reports the ones that took effect.
+	const Status &enable(const std::string &p_port);
+	// Restores what enable() changed.
+	void disable(const std::string &p_port);
+
+	bool is_enabled() const { return enabled; }
+	const Status &get_status() const { return status; }
+};
+
+#endif // SERIAL_LOW_LATENCY_H
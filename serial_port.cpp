@@ -30,105 +30,1848 @@
 
 #include "serial_port.h"
 
+#include "modbus_rtu_master.h"
+#include "serial_port_manager.h"
+
 #ifdef GDEXTENSION
+#include <godot_cpp/classes/engine.hpp>
 #include <godot_cpp/classes/os.hpp>
+#include <godot_cpp/classes/performance.hpp>
+#include <godot_cpp/classes/project_settings.hpp>
+#include <godot_cpp/classes/scene_tree.hpp>
+#include <godot_cpp/classes/scene_tree_timer.hpp>
+#include <godot_cpp/classes/time.hpp>
+#include <godot_cpp/classes/worker_thread_pool.hpp>
 #include <godot_cpp/core/class_db.hpp>
 
-using namespace godot;
-#else
-#include "core/object/class_db.h"
-#include "core/os/memory.h"
-#include "core/os/os.h"
-#endif
-#include <string>
+using namespace godot;
+#else
+#include "core/config/project_settings.h"
+#include "core/object/class_db.h"
+#include "core/object/worker_thread_pool.h"
+#include "core/os/memory.h"
+#include "core/os/os.h"
+#include "core/os/time.h"
+#include "main/performance.h"
+#include "scene/main/scene_tree.h"
+#endif
+#include <algorithm>
+#include <string>
+
+#ifdef SERIAL_PORT_EVENT_MONITOR
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+using namespace std::chrono;
+
+// Oldest packets are dropped once this many are waiting for the main thread.
+static const size_t MAX_QUEUED_PACKETS = 4096;
+// Only the newest packets failing their checksum are kept for `checksum_failed`.
+static const size_t MAX_QUEUED_BAD_PACKETS = 64;
+// Records arriving while this many are waiting for the main thread are dropped.
+static const size_t MAX_QUEUED_RECORDS = 65536;
+// Largest single write of the writer thread, so progress is reported and
+// close() never waits for a whole queued transfer.
+static const size_t TX_CHUNK_SIZE = 4096;
+
+static inline uint64_t _ticks_usec() {
+	return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static String _bytes_to_string(const uint8_t *data, size_t size, bool utf8_encoding) {
+	String str;
+	if (utf8_encoding) {
+		str.parse_utf8((const char *)data, size);
+	} else if (size > 0 && str.resize(size + 1) == OK) {
+		// Plain bytes widened one to one, as when building a String from a C string.
+		char32_t *dst = str.ptrw();
+		for (size_t i = 0; i < size; i++) {
+			dst[i] = data[i];
+		}
+		dst[size] = 0;
+	}
+	return str;
+}
+
+// Writes at the buffer's position, growing it as needed. Only module builds
+// can hand the bytes over without a temporary packed array.
+static void _put_bytes(const Ref<StreamPeerBuffer> &buffer, const uint8_t *data, size_t size) {
+#ifdef GDEXTENSION
+	PackedByteArray bytes;
+	if (size > 0 && bytes.resize(size) == OK) {
+		memcpy(bytes.ptrw(), data, size);
+		buffer->put_data(bytes);
+	}
+#else
+	buffer->put_data(data, size);
+#endif
+}
+
+static SceneTree *_get_scene_tree() {
+#ifdef GDEXTENSION
+	return Object::cast_to<SceneTree>(Engine::get_singleton()->get_main_loop());
+#else
+	return SceneTree::get_singleton();
+#endif
+}
+
+static bool _device_exists(const std::string &port) {
+#ifdef _WIN32
+	for (const PortInfo &info : serial::list_ports()) {
+		if (info.port == port) {
+			return true;
+		}
+	}
+	return false;
+#else
+	return access(port.c_str(), F_OK) == 0;
+#endif
+}
+
+void SerialPort::_data_received() {
+	// Clear first, so bytes arriving while we drain queue a fresh notification.
+	rx_notify_pending = false;
+	_serve_read_requests();
+	// What is left belongs to the request still waiting for more.
+	if (manual_drain || !read_requests.empty()) {
+		return;
+	}
+
+	if (batch_mode == BATCH_MODE_IDLE_FRAME && !_is_batch_due()) {
+		SceneTree *tree = _get_scene_tree();
+		if (tree) {
+			Callable flush = Callable(this, "_flush_batch");
+			if (!tree->is_connected("process_frame", flush)) {
+				tree->connect("process_frame", flush, CONNECT_ONE_SHOT);
+			}
+			return;
+		}
+	}
+	_flush_batch();
+}
+
+bool SerialPort::_is_batch_due() const {
+	if (batch_size_threshold > 0 && rx_buffer.size() >= size_t(batch_size_threshold)) {
+		return true;
+	}
+	uint64_t batch_start = rx_batch_start;
+	return batch_latency_threshold > 0 && batch_start > 0 && _ticks_usec() - batch_start >= uint64_t(batch_latency_threshold);
+}
+
+void SerialPort::_flush_batch() {
+	if (manual_drain || !read_requests.empty()) {
+		return;
+	}
+
+	uint64_t batch_start = rx_batch_start.exchange(0);
+	size_t start = rx_buffer.get_read_position();
+	std::vector<RxStamp> stamps;
+	if (rx_timestamps) {
+		std::lock_guard<std::mutex> lock(rx_stamp_mutex);
+		stamps.assign(rx_stamps.begin(), rx_stamps.end());
+	}
+	PackedByteArray buf = drain_buffered();
+	if (buf.is_empty()) {
+		return;
+	}
+	last_batch_size = buf.size();
+	last_batch_age = batch_start > 0 ? _ticks_usec() - batch_start : 0;
+	if (batch_start > 0) {
+		stats.latency.record(last_batch_age);
+	}
+	if (packet_processor.is_valid()) {
+		_queue_processing(buf);
+	} else {
+		emit_signal("data_received", buf);
+	}
+	if (!rx_timestamps) {
+		return;
+	}
+
+	// Split the batch back into the chunks it was read as.
+	size_t offset = 0;
+	for (const RxStamp &stamp : stamps) {
+		if (stamp.end <= start + offset) {
+			continue;
+		}
+		size_t end = std::min(stamp.end - start, size_t(buf.size()));
+		emit_signal("data_received_timestamped", buf.slice(offset, end), int64_t(stamp.usec) + ticks_offset);
+		offset = end;
+		if (offset == size_t(buf.size())) {
+			break;
+		}
+	}
+	if (offset < size_t(buf.size())) {
+		// Received before timestamps were enabled.
+		emit_signal("data_received_timestamped", buf.slice(offset), -1);
+	}
+}
+
+Ref<SerialReadRequest> SerialPort::_queue_read_request(const PackedByteArray &delimiter, int size, int timeout_ms) {
+	ERR_FAIL_COND_V_MSG(monitoring_should_exit, Ref<SerialReadRequest>(), "Async reads are served by the monitor, start monitoring first.");
+	ERR_FAIL_COND_V_MSG(framing_enabled, Ref<SerialReadRequest>(), "Async reads need the raw byte stream, disable framing first.");
+	ERR_FAIL_COND_V_MSG(size_t(size) > rx_buffer.capacity(), Ref<SerialReadRequest>(), "Async read larger than the receive buffer.");
+
+	Ref<SerialReadRequest> request;
+	request.instantiate();
+	request->delimiter = delimiter;
+	request->size = size;
+	request->scanned_position = rx_buffer.get_read_position();
+	read_requests.push_back(request);
+	read_requests_pending = true;
+
+	if (timeout_ms > 0) {
+		SceneTree *tree = _get_scene_tree();
+		if (tree) {
+			tree->create_timer(timeout_ms / 1000.0)->connect("timeout", Callable(this, "_read_request_timed_out").bind(request));
+		} else {
+			WARN_PRINT("No SceneTree to time the async read out with, it waits indefinitely.");
+		}
+	}
+
+	// The bytes may be buffered already.
+	_serve_read_requests();
+	return request;
+}
+
+void SerialPort::_serve_read_requests() {
+	while (!read_requests.empty()) {
+		Ref<SerialReadRequest> request = read_requests.front();
+		size_t buffered = rx_buffer.size();
+		size_t size = request->size;
+		Error error = OK;
+		if (request->delimiter.is_empty()) {
+			if (buffered < size) {
+				break;
+			}
+		} else {
+			size_t delimiter_size = request->delimiter.size();
+			size_t start = rx_buffer.get_read_position();
+			size_t limit = std::min(buffered, size);
+			// Rescan the tail of the previous pass, a match may straddle it.
+			size_t from = request->scanned_position > start + delimiter_size ? request->scanned_position - start - delimiter_size + 1 : 0;
+			size_t pos = _find_buffered(from, limit, request->delimiter.ptr(), delimiter_size);
+			if (pos < limit) {
+				size = pos + delimiter_size;
+			} else if (limit < size) {
+				request->scanned_position = start + limit;
+				break;
+			} else {
+				// Hand over what was scanned, so the stream isn't stuck on it.
+				error = ERR_INVALID_DATA;
+			}
+		}
+
+		read_requests.pop_front();
+		read_requests_pending = !read_requests.empty();
+		_finish_read_request(request, error, drain_buffered(size));
+	}
+}
+
+size_t SerialPort::_find_buffered(size_t from, size_t limit, const uint8_t *delimiter, size_t delimiter_size) const {
+	size_t offset = from;
+	while (offset < limit) {
+		const uint8_t *span;
+		size_t span_size = std::min(rx_buffer.get_read_span(&span, offset), limit - offset);
+		size_t pos = SerialLineReader::find(span, span_size, delimiter, delimiter_size);
+		if (pos < span_size) {
+			return offset + pos;
+		}
+		offset += span_size;
+		if (offset == limit || delimiter_size == 1) {
+			continue;
+		}
+
+		// The span ends where the ring wraps, a match may straddle it.
+		size_t before = std::min(delimiter_size - 1, offset - from);
+		size_t after = std::min(delimiter_size - 1, limit - offset);
+		thread_local std::vector<uint8_t> scratch;
+		scratch.resize(before + after);
+		rx_buffer.peek(scratch.data(), scratch.size(), offset - before);
+		pos = SerialLineReader::find(scratch.data(), scratch.size(), delimiter, delimiter_size);
+		if (pos < scratch.size()) {
+			return offset - before + pos;
+		}
+	}
+	return limit;
+}
+
+void SerialPort::_finish_read_request(const Ref<SerialReadRequest> &request, Error error, const PackedByteArray &result) {
+	request->_complete(error, result);
+	// Deferred, as the caller only gets to await the request once we return.
+	if (completed_read_requests.empty()) {
+		call_deferred("_read_requests_completed");
+	}
+	completed_read_requests.push_back(request);
+}
+
+void SerialPort::_read_requests_completed() {
+	std::vector<Ref<SerialReadRequest>> completed;
+	completed.swap(completed_read_requests);
+	for (const Ref<SerialReadRequest> &request : completed) {
+		request->emit_signal("completed", request->result);
+	}
+}
+
+void SerialPort::_read_request_timed_out(const Ref<SerialReadRequest> &request) {
+	auto it = std::find(read_requests.begin(), read_requests.end(), request);
+	if (it == read_requests.end()) {
+		return;
+	}
+	read_requests.erase(it);
+	read_requests_pending = !read_requests.empty();
+	_finish_read_request(request, ERR_TIMEOUT, PackedByteArray());
+	// The next request may be satisfied already, or the bytes held back for
+	// this one are due to `data_received`.
+	_data_received();
+}
+
+void SerialPort::_cancel_read_requests() {
+	std::deque<Ref<SerialReadRequest>> cancelled;
+	cancelled.swap(read_requests);
+	read_requests_pending = false;
+	for (const Ref<SerialReadRequest> &request : cancelled) {
+		_finish_read_request(request, ERR_UNAVAILABLE, PackedByteArray());
+	}
+}
+
+size_t SerialPort::_receive(size_t max_size, uint64_t readable_at) {
+	if (framing_enabled) {
+		return _receive_packets(max_size, readable_at);
+	}
+
+	const char *where = __FUNCTION__;
+	size_t size = std::min(_available(where), max_size);
+	if (size == 0) {
+		SerialPortStats::add(stats.empty_polls);
+	}
+	size_t received = link.receive_into(
+			rx_buffer, size,
+			[this, where](uint8_t *p_buffer, size_t p_size) {
+				return _read_bytes(p_buffer, p_size, where);
+			},
+			[this](size_t p_size) {
+				if (!rx_timestamps) {
+					return;
+				}
+				// Stamped before the bytes are published, so any consumed byte has one.
+				uint64_t usec = _ticks_usec();
+				size_t read_position = rx_buffer.get_read_position();
+				std::lock_guard<std::mutex> lock(rx_stamp_mutex);
+				while (!rx_stamps.empty() && rx_stamps.front().end <= read_position) {
+					rx_stamps.pop_front();
+				}
+				rx_stamps.push_back({ rx_buffer.get_write_position() + p_size, usec });
+			});
+
+	if (received > 0) {
+		SerialPortStats::update_max(stats.rx_buffer_high_water, rx_buffer.size());
+		uint64_t no_batch = 0;
+		rx_batch_start.compare_exchange_strong(no_batch, readable_at ? readable_at : _ticks_usec());
+		if ((!manual_drain || read_requests_pending) && !rx_notify_pending.exchange(true)) {
+			call_deferred("_data_received");
+		}
+	}
+	return received;
+}
+
+size_t SerialPort::_receive_packets(size_t max_size, uint64_t readable_at) {
+	size_t size = std::min(_available(__FUNCTION__), max_size);
+	if (size == 0) {
+		SerialPortStats::add(stats.empty_polls);
+	} else {
+		// Delivery latency of packets is measured from the oldest undelivered read.
+		uint64_t no_batch = 0;
+		rx_batch_start.compare_exchange_strong(no_batch, readable_at ? readable_at : _ticks_usec());
+	}
+	size_t received = 0;
+	while (received < size) {
+		size_t bytes_read = _read_bytes(rx_scratch.data(), std::min(rx_scratch.size(), size - received), __FUNCTION__);
+		if (bytes_read == 0) {
+			break;
+		}
+		rx_read_usec = _ticks_usec();
+		std::lock_guard<std::mutex> lock(framer_mutex);
+		framer.feed(rx_scratch.data(), bytes_read, _on_frame, this);
+		received += bytes_read;
+	}
+	return received;
+}
+
+void SerialPort::_on_frame(void *p_user_data, const uint8_t *p_frame, size_t p_size) {
+	SerialPort *serial_port = static_cast<SerialPort *>(p_user_data);
+	SerialChecksum::Type checksum = SerialChecksum::Type(serial_port->checksum_type.load());
+	if (checksum != SerialChecksum::TYPE_NONE && serial_port->checksum_validate) {
+		if (!SerialChecksum::verify(checksum, p_frame, p_size, serial_port->checksum_big_endian)) {
+			serial_port->_on_bad_frame(p_frame, p_size);
+			return;
+		}
+		p_size -= SerialChecksum::get_size(checksum);
+	}
+	if (serial_port->transactions_active && serial_port->_match_transaction(p_frame, p_size)) {
+		return;
+	}
+	if (serial_port->records_enabled) {
+		{
+			std::lock_guard<std::mutex> lock(serial_port->record_mutex);
+			if (serial_port->record_decoder.get_record_count() >= MAX_QUEUED_RECORDS) {
+				serial_port->dropped_records++;
+			} else {
+				serial_port->record_decoder.decode(p_frame, p_size);
+			}
+		}
+		if (!serial_port->manual_drain && !serial_port->record_notify_pending.exchange(true)) {
+			serial_port->call_deferred("_records_received");
+		}
+		return;
+	}
+
+	PackedByteArray packet;
+	if (p_size > 0 && packet.resize(p_size) == OK) {
+		memcpy(packet.ptrw(), p_frame, p_size);
+	}
+	{
+		std::lock_guard<std::mutex> lock(serial_port->packet_mutex);
+		if (serial_port->packets.size() >= MAX_QUEUED_PACKETS) {
+			serial_port->packets.pop_front();
+			serial_port->packet_times.pop_front();
+			serial_port->dropped_packets++;
+		}
+		serial_port->packets.push_back(packet);
+		serial_port->packet_times.push_back(int64_t(serial_port->rx_read_usec) + serial_port->ticks_offset);
+		SerialPortStats::update_max(serial_port->stats.packet_queue_high_water, serial_port->packets.size());
+	}
+	if (!serial_port->manual_drain && !serial_port->packet_notify_pending.exchange(true)) {
+		serial_port->call_deferred("_packets_received");
+	}
+}
+
+void SerialPort::_on_bad_frame(const uint8_t *p_frame, size_t p_size) {
+	checksum_errors++;
+	PackedByteArray packet;
+	if (p_size > 0 && packet.resize(p_size) == OK) {
+		memcpy(packet.ptrw(), p_frame, p_size);
+	}
+	{
+		std::lock_guard<std::mutex> lock(packet_mutex);
+		if (bad_packets.size() >= MAX_QUEUED_BAD_PACKETS) {
+			bad_packets.pop_front();
+		}
+		bad_packets.push_back(packet);
+	}
+	if (!bad_packet_notify_pending.exchange(true)) {
+		call_deferred("_bad_packets_received");
+	}
+}
+
+void SerialPort::_bad_packets_received() {
+	bad_packet_notify_pending = false;
+	std::deque<PackedByteArray> received;
+	{
+		std::lock_guard<std::mutex> lock(packet_mutex);
+		received.swap(bad_packets);
+	}
+	for (const PackedByteArray &packet : received) {
+		emit_signal("checksum_failed", packet);
+	}
+}
+
+void SerialPort::_packets_received() {
+	packet_notify_pending = false;
+	if (manual_drain) {
+		return;
+	}
+
+	std::deque<PackedByteArray> received;
+	std::deque<int64_t> times;
+	bool lines;
+	{
+		std::lock_guard<std::mutex> lock(framer_mutex);
+		lines = framing_mode == FRAMING_LINES;
+	}
+	{
+		std::lock_guard<std::mutex> lock(packet_mutex);
+		received.swap(packets);
+		times.swap(packet_times);
+	}
+	uint64_t batch_start = rx_batch_start.exchange(0);
+	if (batch_start > 0 && !received.empty()) {
+		stats.latency.record(_ticks_usec() - batch_start);
+	}
+	bool timestamped = rx_timestamps;
+	for (size_t i = 0; i < received.size(); i++) {
+		const PackedByteArray &packet = received[i];
+		if (packet_processor.is_valid()) {
+			// Delivered through processed instead, untimestamped.
+			_queue_processing(packet);
+			continue;
+		}
+		if (lines) {
+			emit_signal("line_received", _bytes_to_string(packet.ptr(), packet.size(), true));
+		} else {
+			emit_signal("packet_received", packet);
+		}
+		if (timestamped) {
+			emit_signal("packet_received_timestamped", packet, times[i]);
+		}
+	}
+}
+
+static Variant _column_to_array(const SerialRecordDecoder::Column &column) {
+	size_t size = column.data.size();
+	switch (column.type) {
+		case SerialRecordDecoder::COLUMN_INT32: {
+			PackedInt32Array array;
+			if (size > 0 && array.resize(size / 4) == OK) {
+				memcpy(array.ptrw(), column.data.data(), size);
+			}
+			return array;
+		}
+		case SerialRecordDecoder::COLUMN_INT64: {
+			PackedInt64Array array;
+			if (size > 0 && array.resize(size / 8) == OK) {
+				memcpy(array.ptrw(), column.data.data(), size);
+			}
+			return array;
+		}
+		case SerialRecordDecoder::COLUMN_FLOAT32: {
+			PackedFloat32Array array;
+			if (size > 0 && array.resize(size / 4) == OK) {
+				memcpy(array.ptrw(), column.data.data(), size);
+			}
+			return array;
+		}
+		case SerialRecordDecoder::COLUMN_FLOAT64: {
+			PackedFloat64Array array;
+			if (size > 0 && array.resize(size / 8) == OK) {
+				memcpy(array.ptrw(), column.data.data(), size);
+			}
+			return array;
+		}
+	}
+	return Variant();
+}
+
+Dictionary SerialPort::_take_records(int *r_count) {
+	std::vector<SerialRecordDecoder::Column> columns;
+	{
+		std::lock_guard<std::mutex> lock(record_mutex);
+		*r_count = record_decoder.get_record_count();
+		record_decoder.take_columns(columns);
+	}
+	// Field names only change on the main thread, together with the columns.
+	Dictionary records;
+	for (size_t i = 0; i < columns.size() && int(i) < record_field_names.size(); i++) {
+		records[record_field_names[i]] = _column_to_array(columns[i]);
+	}
+	return records;
+}
+
+void SerialPort::_records_received() {
+	record_notify_pending = false;
+	if (manual_drain) {
+		return;
+	}
+
+	int count;
+	Dictionary records = _take_records(&count);
+	if (count == 0) {
+		return;
+	}
+	uint64_t batch_start = rx_batch_start.exchange(0);
+	if (batch_start > 0) {
+		stats.latency.record(_ticks_usec() - batch_start);
+	}
+	emit_signal("records_received", records, count);
+}
+
+void SerialPort::_queue_processing(const PackedByteArray &data) {
+	if (processing_queue.size() >= MAX_QUEUED_PACKETS) {
+		// Not numbered yet, so dropping it leaves no hole in the sequence.
+		processing_queue.pop_front();
+		dropped_packets++;
+	}
+	processing_queue.push_back({ data, packet_processor });
+	_dispatch_processing();
+}
+
+void SerialPort::_dispatch_processing() {
+	size_t max_tasks = max_processing_tasks > 0 ? max_processing_tasks : OS::get_singleton()->get_processor_count();
+	// Tasks finished out of order keep their slot until emitted, which bounds
+	// the results held back as well.
+	while (!processing_queue.empty() && processing_tasks.size() < max_tasks) {
+		const ProcessingRequest &request = processing_queue.front();
+		uint64_t sequence = processing_next_sequence++;
+		Callable task = Callable(this, "_process_packet").bind(request.processor, int64_t(sequence), request.data);
+		processing_tasks[sequence] = WorkerThreadPool::get_singleton()->add_task(task, false, "SerialPort packet processing");
+		processing_queue.pop_front();
+	}
+}
+
+// Runs on a WorkerThreadPool thread.
+void SerialPort::_process_packet(const Callable &processor, int64_t sequence, const PackedByteArray &data) {
+	Variant result = processor.call(data);
+	{
+		std::lock_guard<std::mutex> lock(processing_mutex);
+		processing_results[sequence] = result;
+	}
+	if (!processing_notify_pending.exchange(true)) {
+		call_deferred("_processing_completed");
+	}
+}
+
+void SerialPort::_processing_completed() {
+	processing_notify_pending = false;
+	while (true) {
+		Variant result;
+		{
+			std::lock_guard<std::mutex> lock(processing_mutex);
+			auto it = processing_results.find(processing_emit_sequence);
+			if (it == processing_results.end()) {
+				break;
+			}
+			result = it->second;
+			processing_results.erase(it);
+		}
+		// The task has returned, but the pool keeps it until waited for.
+		auto task = processing_tasks.find(processing_emit_sequence);
+		WorkerThreadPool::get_singleton()->wait_for_task_completion(task->second);
+		processing_tasks.erase(task);
+		processing_emit_sequence++;
+		emit_signal("processed", result);
+	}
+	_dispatch_processing();
+}
+
+void SerialPort::_wait_processing() {
+	processing_queue.clear();
+	for (const std::pair<const uint64_t, int64_t> &task : processing_tasks) {
+		WorkerThreadPool::get_singleton()->wait_for_task_completion(task.second);
+	}
+	processing_tasks.clear();
+	std::lock_guard<std::mutex> lock(processing_mutex);
+	processing_results.clear();
+	processing_emit_sequence = processing_next_sequence;
+}
+
+void SerialPort::_rx_consumed() {
+	// The link wakes its own monitor, the manager's reactor needs telling.
+	bool was_blocked = link.unblock_receive();
+#ifdef SERIAL_PORT_EVENT_MONITOR
+	if (was_blocked && monitoring_shared) {
+		_wakeup_monitor();
+	}
+#endif
+}
+
+SerialPort::SerialPort(const String &port, uint32_t baudrate, uint32_t timeout, ByteSize bytesize, Parity parity, StopBits stopbits, FlowControl flowcontrol) :
+		link(stats) {
+	serial = new Serial(port.ascii().get_data(),
+			baudrate, Timeout::simpleTimeout(timeout), bytesize_t(bytesize), parity_t(parity), stopbits_t(stopbits), flowcontrol_t(flowcontrol));
+	rx_buffer.resize(65536);
+	rx_scratch.resize(4096);
+	ticks_offset = int64_t(Time::get_singleton()->get_ticks_usec()) - int64_t(_ticks_usec());
+}
+
+void SerialPort::_tx_thread_func(void *p_user_data) {
+	SerialPort *serial_port = static_cast<SerialPort *>(p_user_data);
+	serial_port->_tx_loop();
+}
+
+void SerialPort::_tx_loop() {
+	std::unique_lock<std::mutex> lock(tx_mutex);
+	while (true) {
+		auto ready = [this] { return tx_should_exit || !tx_queue.empty() || transactions.can_dispatch(); };
+		uint64_t deadline = transactions.get_next_deadline();
+		if (deadline > 0) {
+			tx_cond.wait_until(lock, steady_clock::time_point(microseconds(deadline)), ready);
+		} else {
+			tx_cond.wait(lock, ready);
+		}
+		if (tx_should_exit) {
+			break;
+		}
+		_dispatch_transactions();
+		if (tx_queue.empty()) {
+			continue;
+		}
+
+		// Only this thread pops, so the request outlives the unlocked write.
+		TxRequest &request = tx_queue.front();
+		const uint8_t *data = request.data.ptr() + request.offset;
+		size_t size = std::min(size_t(request.data.size()) - request.offset, TX_CHUNK_SIZE);
+		bool paced = tx_pacer.is_enabled();
+		if (paced) {
+			// Read every time, so a new baud rate applies from the next chunk.
+			lock.unlock();
+			double byte_usec = _get_byte_time_usec();
+			lock.lock();
+			tx_pacer.set_byte_time_usec(byte_usec);
+			uint64_t wait_usec = 0;
+			size = tx_pacer.acquire(_ticks_usec(), size, &wait_usec);
+			if (size == 0) {
+				tx_cond.wait_for(lock, microseconds(wait_usec), [this] { return tx_should_exit; });
+				continue;
+			}
+		}
+		lock.unlock();
+		Error err = OK;
+		size_t written = _write_bytes(data, size, "write_async", &err);
+		lock.lock();
+		if (paced && written > 0) {
+			tx_pacer.commit(_ticks_usec(), written);
+		}
+
+		if (err != OK) {
+			if (connection_state != CONNECTION_FAILED && is_open()) {
+				// Backing off after an error, the chunk is written again once the
+				// port may be tried, a millisecond later at the earliest.
+				int64_t retry_delay = std::max<int64_t>(_retry_delay_usec(), 1000);
+				tx_cond.wait_for(lock, microseconds(retry_delay), [this] { return tx_should_exit; });
+				continue;
+			}
+			// The port failed for good, nothing queued can be delivered any more.
+			_fail_tx_queue(err);
+		} else if (written == 0) {
+			// Write timeout without progress, give the device time to drain.
+			lock.unlock();
+			std::this_thread::sleep_for(milliseconds(1));
+			lock.lock();
+			continue;
+		} else {
+			request.offset += written;
+			tx_queued_bytes -= written;
+			if (request.offset < size_t(request.data.size())) {
+				continue;
+			}
+			if (request.transaction) {
+				// Its timeout runs from here, so a backlog ahead of it doesn't count.
+				transactions.mark_sent(request.transaction_id, _ticks_usec());
+			} else if (request.id != 0) {
+				tx_completed.push_back(request.id);
+			}
+			tx_queue.pop_front();
+		}
+
+		if (!tx_notify_pending.exchange(true)) {
+			call_deferred("_tx_progress");
+		}
+	}
+}
+
+void SerialPort::_stop_writer() {
+	{
+		std::lock_guard<std::mutex> lock(tx_mutex);
+		tx_should_exit = true;
+	}
+	tx_cond.notify_one();
+	if (tx_thread.joinable()) {
+		tx_thread.join();
+	}
+
+	std::lock_guard<std::mutex> lock(tx_mutex);
+	tx_should_exit = false;
+	_fail_tx_queue(ERR_UNAVAILABLE);
+	if (!tx_failed.empty() && !tx_notify_pending.exchange(true)) {
+		call_deferred("_tx_progress");
+	}
+	tx_full = false;
+	tx_pacer.reset();
+	size_t pending = transactions.get_in_flight_count() + transactions.get_waiting_count();
+	if (pending > 0) {
+		transactions.cancel(transaction_completions);
+		transactions_active = false;
+		stats.transactions_in_flight = 0;
+		SerialPortStats::add(stats.transactions_failed, pending);
+		_notify_transactions();
+	}
+}
+
+// Called with `tx_mutex` held.
+void SerialPort::_fail_tx_queue(Error error) {
+	uint64_t now = _ticks_usec();
+	for (const TxRequest &request : tx_queue) {
+		if (request.transaction) {
+			// Lost like an unanswered attempt, it times out and is retried.
+			transactions.mark_sent(request.transaction_id, now);
+		} else if (request.id != 0) {
+			tx_failed.push_back({ request.id, error });
+		}
+	}
+	tx_queue.clear();
+	tx_queued_bytes = 0;
+}
+
+void SerialPort::_tx_progress() {
+	tx_notify_pending = false;
+
+	std::vector<uint64_t> completed;
+	std::vector<std::pair<uint64_t, Error>> failed;
+	size_t queued_bytes;
+	{
+		std::lock_guard<std::mutex> lock(tx_mutex);
+		completed.swap(tx_completed);
+		failed.swap(tx_failed);
+		queued_bytes = tx_queued_bytes;
+	}
+	for (uint64_t id : completed) {
+		emit_signal("write_completed", int64_t(id));
+	}
+	for (const std::pair<uint64_t, Error> &request : failed) {
+		emit_signal("write_failed", int64_t(request.first), request.second);
+	}
+	if (tx_full && queued_bytes <= size_t(tx_queue_low_watermark)) {
+		tx_full = false;
+		emit_signal("tx_queue_low");
+	}
+}
+
+double SerialPort::_get_byte_time_usec() const {
+	std::shared_lock<SerialPortLock> lock(link.get_lock());
+	stopbits_t stopbits = serial->getStopbits();
+	double stop_bits = stopbits == stopbits_two ? 2.0 : (stopbits == stopbits_one_point_five ? 1.5 : 1.0);
+	return SerialTxPacer::get_byte_time_usec(serial->getBaudrate(), serial->getBytesize(), serial->getParity() != parity_none, stop_bits);
+}
+
+// Called with `tx_mutex` held.
+void SerialPort::_dispatch_transactions() {
+	uint64_t now = _ticks_usec();
+	size_t completions = transaction_completions.size();
+	int retried = transactions.expire(now, transaction_completions);
+	SerialPortStats::add(stats.transaction_retries, retried);
+
+	int64_t id;
+	std::vector<uint8_t> request;
+	while (transactions.dispatch(&id, request)) {
+		PackedByteArray frame;
+		if (frame.resize(request.size()) == OK) {
+			memcpy(frame.ptrw(), request.data(), request.size());
+		}
+		tx_queue.push_back({ 0, frame, 0, true, id });
+		tx_queued_bytes += frame.size();
+		SerialPortStats::update_max(stats.tx_queue_high_water, tx_queued_bytes);
+	}
+
+	size_t in_flight = transactions.get_in_flight_count();
+	transactions_active = in_flight > 0;
+	stats.transactions_in_flight = in_flight;
+	SerialPortStats::update_max(stats.transactions_in_flight_high_water, in_flight);
+	if (transaction_completions.size() > completions) {
+		SerialPortStats::add(stats.transactions_failed, transaction_completions.size() - completions);
+		_notify_transactions();
+	}
+}
+
+// Monitor thread, true if the frame was a response to a transaction in flight.
+bool SerialPort::_match_transaction(const uint8_t *p_frame, size_t p_size) {
+	SerialTransactionQueue::Completion completion;
+	{
+		std::lock_guard<std::mutex> lock(tx_mutex);
+		if (!transactions.match(p_frame, p_size, _ticks_usec(), completion)) {
+			return false;
+		}
+		transactions_active = transactions.get_in_flight_count() > 0;
+		stats.transactions_in_flight = transactions.get_in_flight_count();
+		SerialPortStats::add(stats.transactions_completed);
+		stats.transaction_latency.record(completion.latency_usec);
+		transaction_completions.push_back(std::move(completion));
+		_notify_transactions();
+	}
+	// A slot is free for the next waiting request.
+	tx_cond.notify_one();
+	return true;
+}
+
+void SerialPort::_notify_transactions() {
+	if (!transaction_notify_pending.exchange(true)) {
+		call_deferred("_transactions_completed");
+	}
+}
+
+void SerialPort::_transactions_completed() {
+	transaction_notify_pending = false;
+
+	std::vector<SerialTransactionQueue::Completion> completed;
+	{
+		std::lock_guard<std::mutex> lock(tx_mutex);
+		completed.swap(transaction_completions);
+	}
+	for (const SerialTransactionQueue::Completion &completion : completed) {
+		if (completion.status != SerialTransactionQueue::STATUS_COMPLETED) {
+			emit_signal("transaction_failed", completion.id, completion.status == SerialTransactionQueue::STATUS_TIMED_OUT ? ERR_TIMEOUT : ERR_UNAVAILABLE);
+			continue;
+		}
+		PackedByteArray response;
+		if (!completion.response.empty() && response.resize(completion.response.size()) == OK) {
+			memcpy(response.ptrw(), completion.response.data(), completion.response.size());
+		}
+		emit_signal("transaction_completed", completion.id, response);
+	}
+}
+
+SerialPort::~SerialPort() {
+	if (modbus_master) {
+		modbus_master->_detach_serial_port();
+	}
+	_wait_processing();
+	set_auto_reconnect(false);
+	remove_performance_monitors();
+	read_requests.clear();
+	close();
+	stop_monitoring();
+	delete serial;
+}
+
+Dictionary SerialPort::list_ports() {
+	std::vector<PortInfo> ports_info = serial::list_ports();
+
+	Dictionary info_dict;
+	for (PortInfo port : ports_info) {
+		Dictionary info;
+		info["desc"] = port.description.c_str();
+		info["hw_id"] = port.hardware_id.c_str();
+		info_dict[port.port.c_str()] = Variant(info);
+	}
+
+	return info_dict;
+}
+
+void SerialPort::_on_io_error(const String &where, const String &what) {
+	if (is_open()) {
+		_enter_backoff();
+	} else {
+		link.set_receiving(false);
+	}
+	// The monitor has stopped reading, reopen once the device is back.
+	if (auto_reconnect && !reconnecting && serial_open && !_device_exists(get_port().utf8().get_data()) && !disconnect_pending.exchange(true)) {
+		call_deferred("_on_disconnected");
+	}
+	_on_error(where, what);
+}
+
+void SerialPort::_on_error(const String &where, const String &what) {
+	stats.record_error(where.utf8().get_data());
+	{
+		std::lock_guard<std::mutex> lock(error_mutex);
+		error_message = "[" + get_port() + "] Error at " + where + ": " + what;
+		uint64_t now = _ticks_usec();
+		if (error_message == emitted_error && now - error_signal_usec < uint64_t(error_signal_interval) * 1000) {
+			suppressed_errors++;
+			return;
+		}
+		emitted_error = error_message;
+		error_signal_usec = now;
+	}
+	// Errors come from the monitor, reactor and writer threads as well, and
+	// handlers are free to close or reconfigure the port.
+	call_deferred("_on_error_deferred", where, what);
+}
+
+void SerialPort::_on_error_deferred(const String &where, const String &what) {
+	emit_signal("got_error", where, what);
+}
+
+String SerialPort::get_last_error() {
+	std::lock_guard<std::mutex> lock(error_mutex);
+	return error_message;
+}
+
+bool SerialPort::_attempt_allowed(const char *where) {
+	if (link.is_receiving()) {
+		return true;
+	}
+	if (connection_state == CONNECTION_DEGRADED && _ticks_usec() >= retry_at_usec) {
+		// Let one call through to probe the port, the next error backs off further.
+		link.set_receiving(true);
+		return true;
+	}
+	if (!is_open()) {
+		_on_error(where, "Port not opened");
+	}
+	return false;
+}
+
+void SerialPort::_enter_backoff() {
+	link.set_receiving(false);
+	int errors = ++consecutive_errors;
+	if (error_failure_threshold > 0 && errors >= error_failure_threshold) {
+		_set_connection_state(CONNECTION_FAILED);
+		return;
+	}
+	uint64_t delay = std::min<uint64_t>(uint64_t(error_retry_min_delay) << std::min(errors - 1, 20), error_retry_max_delay);
+	retry_at_usec = _ticks_usec() + delay * 1000;
+	_set_connection_state(CONNECTION_DEGRADED);
+}
+
+void SerialPort::_recover() {
+	consecutive_errors = 0;
+	link.set_receiving(true);
+	_set_connection_state(CONNECTION_OK);
+}
+
+void SerialPort::_set_connection_state(ConnectionState state) {
+	if (connection_state.exchange(state) != state && !connection_state_notify_pending.exchange(true)) {
+		call_deferred("_connection_state_changed");
+	}
+}
+
+void SerialPort::_connection_state_changed() {
+	connection_state_notify_pending = false;
+	ConnectionState state = get_connection_state();
+	if (state != emitted_connection_state) {
+		emitted_connection_state = state;
+		emit_signal("connection_state_changed", state);
+	}
+}
+
+int64_t SerialPort::_retry_delay_usec() const {
+	if (link.is_receiving() || connection_state != CONNECTION_DEGRADED || !is_open()) {
+		return -1;
+	}
+	uint64_t now = _ticks_usec();
+	return retry_at_usec > now ? retry_at_usec - now : 0;
+}
+
+Error SerialPort::start_monitoring(uint64_t interval_in_usec) {
+	ERR_FAIL_COND_V_MSG(!monitoring_should_exit, ERR_ALREADY_IN_USE, "Monitor already started.");
+	stop_monitoring();
+	monitoring_should_exit = false;
+	monitoring_interval = interval_in_usec;
+	link.set_receiving(is_open());
+#ifdef SERIAL_PORT_EVENT_MONITOR
+	if (monitoring_mode == MONITORING_MODE_SHARED && SerialPortManager::get_singleton()->register_port(this) == OK) {
+		monitoring_shared = true;
+		return OK;
+	}
+#endif
+	SerialLink::Callbacks callbacks;
+	callbacks.user_data = this;
+	callbacks.can_read = _link_can_read;
+	callbacks.get_retry_delay = _link_get_retry_delay;
+	callbacks.open_fd = _link_open_fd;
+	callbacks.receive = _link_receive;
+	callbacks.on_error = _link_on_error;
+	// Also the fallback of MONITORING_MODE_SHARED if the manager refused the port.
+	SerialLink::MonitorMode mode = monitoring_mode == MONITORING_MODE_POLLING ? SerialLink::MONITOR_POLLING : SerialLink::MONITOR_EVENT_DRIVEN;
+	if (!link.start_monitoring(mode, monitoring_interval, callbacks)) {
+		monitoring_should_exit = true;
+		ERR_FAIL_V_MSG(ERR_CANT_CREATE, "Failed to create monitor wakeup pipe.");
+	}
+
+	return OK;
+}
+
+void SerialPort::stop_monitoring() {
+	monitoring_should_exit = true;
+#ifdef SERIAL_PORT_EVENT_MONITOR
+	if (monitoring_shared) {
+		SerialPortManager::get_singleton()->unregister_port(this);
+		monitoring_shared = false;
+	}
+#endif
+	link.stop_monitoring();
+}
+
+void SerialPort::set_monitoring_mode(MonitoringMode mode) {
+	monitoring_mode = mode;
+}
+
+SerialPort::MonitoringMode SerialPort::get_monitoring_mode() const {
+	return monitoring_mode;
+}
+
+Error SerialPort::set_rx_buffer_capacity(int capacity) {
+	ERR_FAIL_COND_V_MSG(!monitoring_should_exit, ERR_ALREADY_IN_USE, "Can't resize the receive buffer while monitoring.");
+	ERR_FAIL_COND_V(capacity <= 0, ERR_INVALID_PARAMETER);
+	rx_buffer.resize(capacity);
+	return OK;
+}
+
+int SerialPort::get_rx_buffer_capacity() const {
+	return rx_buffer.capacity();
+}
+
+void SerialPort::set_manual_drain(bool enabled) {
+	manual_drain = enabled;
+}
+
+bool SerialPort::is_manual_drain() const {
+	return manual_drain;
+}
+
+void SerialPort::set_batch_mode(BatchMode mode) {
+	batch_mode = mode;
+}
+
+SerialPort::BatchMode SerialPort::get_batch_mode() const {
+	return batch_mode;
+}
+
+void SerialPort::set_batch_size_threshold(int size) {
+	batch_size_threshold = size;
+}
+
+int SerialPort::get_batch_size_threshold() const {
+	return batch_size_threshold;
+}
+
+void SerialPort::set_batch_latency_threshold(int usec) {
+	batch_latency_threshold = usec;
+}
+
+int SerialPort::get_batch_latency_threshold() const {
+	return batch_latency_threshold;
+}
+
+void SerialPort::set_framing_mode(FramingMode mode) {
+	std::lock_guard<std::mutex> lock(framer_mutex);
+	framing_mode = mode;
+	// Lines are delimited packets converted to String on delivery.
+	framer.set_mode(mode == FRAMING_LINES ? SerialFramer::MODE_DELIMITER : SerialFramer::Mode(mode));
+	framing_enabled = mode != FRAMING_NONE;
+}
+
+SerialPort::FramingMode SerialPort::get_framing_mode() const {
+	std::lock_guard<std::mutex> lock(framer_mutex);
+	return framing_mode;
+}
+
+void SerialPort::set_frame_delimiter(const PackedByteArray &delimiter) {
+	std::lock_guard<std::mutex> lock(framer_mutex);
+	framer.set_delimiter(delimiter.ptr(), delimiter.size());
+}
+
+PackedByteArray SerialPort::get_frame_delimiter() const {
+	std::lock_guard<std::mutex> lock(framer_mutex);
+	const std::vector<uint8_t> &delimiter = framer.get_delimiter();
+	PackedByteArray buf;
+	if (!delimiter.empty() && buf.resize(delimiter.size()) == OK) {
+		memcpy(buf.ptrw(), delimiter.data(), delimiter.size());
+	}
+	return buf;
+}
+
+void SerialPort::set_frame_length(int length) {
+	ERR_FAIL_COND(length <= 0);
+	std::lock_guard<std::mutex> lock(framer_mutex);
+	framer.set_frame_length(length);
+}
+
+int SerialPort::get_frame_length() const {
+	std::lock_guard<std::mutex> lock(framer_mutex);
+	return framer.get_frame_length();
+}
+
+void SerialPort::set_length_field_offset(int offset) {
+	ERR_FAIL_COND(offset < 0);
+	std::lock_guard<std::mutex> lock(framer_mutex);
+	framer.set_length_field(offset, framer.get_length_field_size(), framer.is_length_field_big_endian(), framer.get_length_adjustment());
+}
+
+int SerialPort::get_length_field_offset() const {
+	std::lock_guard<std::mutex> lock(framer_mutex);
+	return framer.get_length_field_offset();
+}
+
+void SerialPort::set_length_field_size(int size) {
+	ERR_FAIL_COND_MSG(size < 1 || size > 8, "Length field size must be between 1 and 8 bytes.");
+	std::lock_guard<std::mutex> lock(framer_mutex);
+	framer.set_length_field(framer.get_length_field_offset(), size, framer.is_length_field_big_endian(), framer.get_length_adjustment());
+}
+
+int SerialPort::get_length_field_size() const {
+	std::lock_guard<std::mutex> lock(framer_mutex);
+	return framer.get_length_field_size();
+}
+
+void SerialPort::set_length_field_big_endian(bool big_endian) {
+	std::lock_guard<std::mutex> lock(framer_mutex);
+	framer.set_length_field(framer.get_length_field_offset(), framer.get_length_field_size(), big_endian, framer.get_length_adjustment());
+}
+
+bool SerialPort::is_length_field_big_endian() const {
+	std::lock_guard<std::mutex> lock(framer_mutex);
+	return framer.is_length_field_big_endian();
+}
+
+void SerialPort::set_length_adjustment(int adjustment) {
+	std::lock_guard<std::mutex> lock(framer_mutex);
+	framer.set_length_field(framer.get_length_field_offset(), framer.get_length_field_size(), framer.is_length_field_big_endian(), adjustment);
+}
+
+int SerialPort::get_length_adjustment() const {
+	std::lock_guard<std::mutex> lock(framer_mutex);
+	return framer.get_length_adjustment();
+}
+
+void SerialPort::set_max_frame_size(int size) {
+	ERR_FAIL_COND(size < 0);
+	std::lock_guard<std::mutex> lock(framer_mutex);
+	framer.set_max_frame_size(size);
+}
+
+int SerialPort::get_max_frame_size() const {
+	std::lock_guard<std::mutex> lock(framer_mutex);
+	return framer.get_max_frame_size();
+}
+
+int SerialPort::get_available_packet_count() {
+	std::lock_guard<std::mutex> lock(packet_mutex);
+	return packets.size();
+}
+
+PackedByteArray SerialPort::get_packet() {
+	std::lock_guard<std::mutex> lock(packet_mutex);
+	ERR_FAIL_COND_V_MSG(packets.empty(), PackedByteArray(), "No packet available.");
+	PackedByteArray packet = packets.front();
+	packets.pop_front();
+	packet_times.pop_front();
+	return packet;
+}
+
+int64_t SerialPort::get_packet_timestamp() {
+	std::lock_guard<std::mutex> lock(packet_mutex);
+	return packet_times.empty() ? -1 : packet_times.front();
+}
+
+void SerialPort::set_rx_timestamps(bool enabled) {
+	rx_timestamps = enabled;
+}
+
+bool SerialPort::is_rx_timestamps() const {
+	return rx_timestamps;
+}
+
+int64_t SerialPort::get_buffered_timestamp() const {
+	size_t read_position = rx_buffer.get_read_position();
+	if (rx_buffer.size() == 0) {
+		return -1;
+	}
+	std::lock_guard<std::mutex> lock(rx_stamp_mutex);
+	for (const RxStamp &stamp : rx_stamps) {
+		if (stamp.end > read_position) {
+			return int64_t(stamp.usec) + ticks_offset;
+		}
+	}
+	return -1;
+}
+
+int SerialPort::get_dropped_frames() const {
+	std::lock_guard<std::mutex> lock(framer_mutex);
+	return framer.get_dropped_frames() + dropped_packets;
+}
+
+void SerialPort::set_checksum_type(ChecksumType type) {
+	checksum_type = type;
+}
+
+SerialPort::ChecksumType SerialPort::get_checksum_type() const {
+	return checksum_type;
+}
+
+void SerialPort::set_checksum_big_endian(bool big_endian) {
+	checksum_big_endian = big_endian;
+}
+
+bool SerialPort::is_checksum_big_endian() const {
+	return checksum_big_endian;
+}
+
+void SerialPort::set_checksum_validate(bool enabled) {
+	checksum_validate = enabled;
+}
+
+bool SerialPort::is_checksum_validate() const {
+	return checksum_validate;
+}
+
+void SerialPort::set_checksum_append(bool enabled) {
+	checksum_append = enabled;
+}
+
+bool SerialPort::is_checksum_append() const {
+	return checksum_append;
+}
+
+int SerialPort::get_checksum_errors() const {
+	return checksum_errors;
+}
+
+int64_t SerialPort::compute_checksum(ChecksumType type, const PackedByteArray &data) {
+	return SerialChecksum::compute(SerialChecksum::Type(type), data.ptr(), data.size());
+}
+
+PackedByteArray SerialPort::_with_checksum(const PackedByteArray &data) const {
+	SerialChecksum::Type checksum = SerialChecksum::Type(checksum_type.load());
+	if (checksum == SerialChecksum::TYPE_NONE || !checksum_append) {
+		return data;
+	}
+	size_t size = data.size();
+	PackedByteArray frame;
+	if (frame.resize(size + SerialChecksum::get_size(checksum)) == OK) {
+		uint8_t *dst = frame.ptrw();
+		memcpy(dst, data.ptr(), size);
+		SerialChecksum::encode(checksum, SerialChecksum::compute(checksum, dst, size), checksum_big_endian, dst + size);
+	}
+	return frame;
+}
+
+Error SerialPort::set_record_schema(const Array &fields, int record_size) {
+	ERR_FAIL_COND_V(record_size < 0, ERR_INVALID_PARAMETER);
+
+	std::vector<SerialRecordDecoder::Field> schema;
+	Vector<String> names;
+	for (int i = 0; i < fields.size(); i++) {
+		ERR_FAIL_COND_V_MSG(fields[i].get_type() != Variant::DICTIONARY, ERR_INVALID_PARAMETER, "Record fields must be dictionaries.");
+		Dictionary field = fields[i];
+		String name = field.get("name", "");
+		ERR_FAIL_COND_V_MSG(name.is_empty() || names.has(name), ERR_INVALID_PARAMETER, "Record field names must be unique and not empty.");
+		int type = field.get("type", RECORD_FIELD_UINT8);
+		ERR_FAIL_COND_V_MSG(type < RECORD_FIELD_INT8 || type > RECORD_FIELD_FLOAT64, ERR_INVALID_PARAMETER, "Invalid type of record field \"" + name + "\".");
+
+		SerialRecordDecoder::Field decoder_field;
+		decoder_field.name = name.utf8().get_data();
+		decoder_field.type = SerialRecordDecoder::FieldType(type);
+		decoder_field.offset = int64_t(field.get("offset", -1));
+		decoder_field.big_endian = field.get("big_endian", false);
+		schema.push_back(decoder_field);
+		names.push_back(name);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(record_mutex);
+		ERR_FAIL_COND_V_MSG(!record_decoder.set_fields(schema, record_size), ERR_INVALID_PARAMETER, "Record fields don't fit in the record size.");
+	}
+	record_field_names = names;
+	records_enabled = !schema.empty();
+	return OK;
+}
+
+Array SerialPort::get_record_schema() const {
+	std::lock_guard<std::mutex> lock(record_mutex);
+	Array fields;
+	for (const SerialRecordDecoder::Field &decoder_field : record_decoder.get_fields()) {
+		Dictionary field;
+		field["name"] = String::utf8(decoder_field.name.c_str());
+		field["type"] = int(decoder_field.type);
+		field["offset"] = decoder_field.offset;
+		field["big_endian"] = decoder_field.big_endian;
+		fields.push_back(field);
+	}
+	return fields;
+}
+
+int SerialPort::get_record_size() const {
+	std::lock_guard<std::mutex> lock(record_mutex);
+	return record_decoder.get_record_size();
+}
+
+int SerialPort::get_available_record_count() const {
+	std::lock_guard<std::mutex> lock(record_mutex);
+	return record_decoder.get_record_count();
+}
+
+Dictionary SerialPort::drain_records() {
+	int count;
+	return _take_records(&count);
+}
+
+int SerialPort::get_dropped_records() const {
+	std::lock_guard<std::mutex> lock(record_mutex);
+	return record_decoder.get_dropped_records() + dropped_records;
+}
+
+void SerialPort::set_packet_processor(const Callable &processor) {
+	packet_processor = processor;
+}
+
+Callable SerialPort::get_packet_processor() const {
+	return packet_processor;
+}
+
+void SerialPort::set_max_processing_tasks(int count) {
+	ERR_FAIL_COND(count < 0);
+	max_processing_tasks = count;
+	_dispatch_processing();
+}
+
+int SerialPort::get_max_processing_tasks() const {
+	return max_processing_tasks;
+}
+
+int SerialPort::get_processing_tasks() const {
+	return processing_tasks.size();
+}
+
+int SerialPort::get_queued_processing() const {
+	return processing_queue.size();
+}
+
+int SerialPort::get_buffered_bytes() const {
+	return rx_buffer.size();
+}
+
+PackedByteArray SerialPort::peek_buffered(int max_size) const {
+	PackedByteArray buf;
+	size_t size = rx_buffer.size();
+	if (max_size >= 0) {
+		size = std::min(size, size_t(max_size));
+	}
+	if (size > 0 && buf.resize(size) == OK) {
+		rx_buffer.peek(buf.ptrw(), size);
+	}
+	return buf;
+}
+
+PackedByteArray SerialPort::drain_buffered(int max_size) {
+	PackedByteArray buf = peek_buffered(max_size);
+	rx_buffer.skip(buf.size());
+	_rx_consumed();
+	return buf;
+}
+
+int SerialPort::drain_into(const Ref<StreamPeerBuffer> &buffer, int max_size) {
+	ERR_FAIL_COND_V(buffer.is_null(), 0);
+	size_t size = rx_buffer.size();
+	if (max_size >= 0) {
+		size = std::min(size, size_t(max_size));
+	}
+	size_t moved = 0;
+	while (moved < size) {
+		const uint8_t *span;
+		size_t span_size = std::min(rx_buffer.get_read_span(&span), size - moved);
+		_put_bytes(buffer, span, span_size);
+		rx_buffer.skip(span_size);
+		moved += span_size;
+	}
+	_rx_consumed();
+	return moved;
+}
+
+void SerialPort::clear_buffered() {
+	line_reader.clear();
+	rx_batch_start = 0;
+	rx_buffer.clear();
+	_rx_consumed();
+
+	{
+		std::lock_guard<std::mutex> lock(framer_mutex);
+		framer.reset();
+	}
+	{
+		std::lock_guard<std::mutex> lock(record_mutex);
+		record_decoder.clear();
+	}
+	{
+		std::lock_guard<std::mutex> lock(rx_stamp_mutex);
+		rx_stamps.clear();
+	}
+	std::lock_guard<std::mutex> lock(packet_mutex);
+	packets.clear();
+	packet_times.clear();
+	bad_packets.clear();
+}
+
+Ref<SerialReadRequest> SerialPort::read_async(int size, int timeout_ms) {
+	ERR_FAIL_COND_V(size <= 0, Ref<SerialReadRequest>());
+	return _queue_read_request(PackedByteArray(), size, timeout_ms);
+}
+
+Ref<SerialReadRequest> SerialPort::read_until_async(const PackedByteArray &delimiter, int max_size, int timeout_ms) {
+	ERR_FAIL_COND_V(delimiter.is_empty(), Ref<SerialReadRequest>());
+	ERR_FAIL_COND_V(max_size < delimiter.size(), Ref<SerialReadRequest>());
+	return _queue_read_request(delimiter, max_size, timeout_ms);
+}
+
+static void _add_latency_stats(Dictionary &r_stats, const String &prefix, const SerialPortStats::Latency &latency) {
+	uint64_t count = latency.count;
+	r_stats[prefix + "count"] = count;
+	r_stats[prefix + "mean_usec"] = count > 0 ? latency.total / count : 0;
+	r_stats[prefix + "p50_usec"] = latency.percentile(0.5);
+	r_stats[prefix + "p99_usec"] = latency.percentile(0.99);
+	r_stats[prefix + "max_usec"] = latency.max.load();
+}
+
+Dictionary SerialPort::get_stats() const {
+	Dictionary result;
+	result["rx_bytes"] = stats.rx_bytes.load();
+	result["rx_chunks"] = stats.rx_chunks.load();
+	result["read_calls"] = stats.read_calls.load();
+	result["tx_bytes"] = stats.tx_bytes.load();
+	result["tx_chunks"] = stats.tx_chunks.load();
+	result["write_calls"] = stats.write_calls.load();
+	result["monitor_wakeups"] = stats.monitor_wakeups.load();
+	result["empty_polls"] = stats.empty_polls.load();
+	result["errors"] = stats.errors.load();
+	result["rx_buffer_high_water"] = stats.rx_buffer_high_water.load();
+	result["packet_queue_high_water"] = stats.packet_queue_high_water.load();
+	result["tx_queue_high_water"] = stats.tx_queue_high_water.load();
+
+	_add_latency_stats(result, "latency_", stats.latency);
+	PackedInt64Array histogram;
+	histogram.resize(SerialPortStats::LATENCY_BUCKETS);
+	for (int i = 0; i < SerialPortStats::LATENCY_BUCKETS; i++) {
+		histogram.set(i, stats.latency.buckets[i]);
+	}
+	result["latency_histogram"] = histogram;
+
+	result["transactions_completed"] = stats.transactions_completed.load();
+	result["transactions_failed"] = stats.transactions_failed.load();
+	result["transaction_retries"] = stats.transaction_retries.load();
+	result["transactions_in_flight"] = stats.transactions_in_flight.load();
+	result["transactions_in_flight_high_water"] = stats.transactions_in_flight_high_water.load();
+	_add_latency_stats(result, "transaction_latency_", stats.transaction_latency);
+
+	Dictionary errors_by_where;
+	{
+		std::lock_guard<std::mutex> lock(stats.errors_mutex);
+		for (const std::pair<const std::string, uint64_t> &error : stats.errors_by_where) {
+			errors_by_where[String::utf8(error.first.c_str())] = error.second;
+		}
+	}
+	result["errors_by_where"] = errors_by_where;
+	return result;
+}
+
+void SerialPort::reset_stats() {
+	stats.reset();
+}
+
+int64_t SerialPort::_get_stat(const String &name) const {
+	return get_stats()[name];
+}
+
+Error SerialPort::add_performance_monitors(const String &category) {
+	ERR_FAIL_COND_V_MSG(!performance_monitor_category.is_empty(), ERR_ALREADY_IN_USE, "Performance monitors already added.");
+	performance_monitor_category = category.is_empty() ? "SerialPort " + get_port() : category;
+
+	Performance *performance = Performance::get_singleton();
+	Array names = get_stats().keys();
+	for (int i = 0; i < names.size(); i++) {
+		String name = names[i];
+		if (name == "latency_histogram" || name == "errors_by_where") {
+			continue;
+		}
+#ifdef GDEXTENSION
+		Array args;
+		args.push_back(name);
+#else
+		Vector<Variant> args;
+		args.push_back(name);
+#endif
+		performance->add_custom_monitor(performance_monitor_category + "/" + name, Callable(this, "_get_stat"), args);
+	}
+	return OK;
+}
+
+void SerialPort::remove_performance_monitors() {
+	if (performance_monitor_category.is_empty()) {
+		return;
+	}
+	Performance *performance = Performance::get_singleton();
+	Array names = get_stats().keys();
+	for (int i = 0; i < names.size(); i++) {
+		String id = performance_monitor_category + "/" + String(names[i]);
+		if (performance->has_custom_monitor(id)) {
+			performance->remove_custom_monitor(id);
+		}
+	}
+	performance_monitor_category = "";
+}
+
+Error SerialPort::start_capture(const String &path) {
+	String global_path = ProjectSettings::get_singleton()->globalize_path(path);
+	if (!capture.open(global_path.utf8().get_data(), capture_segment_size, capture_max_segments)) {
+		ERR_FAIL_V_MSG(ERR_CANT_CREATE, "Can't create capture file: " + global_path);
+	}
+	return OK;
+}
+
+void SerialPort::stop_capture() {
+	capture.close();
+}
+
+bool SerialPort::is_capturing() const {
+	return capture.is_open();
+}
+
+void SerialPort::set_capture_segment_size(int size) {
+	ERR_FAIL_COND(size < 4096);
+	capture_segment_size = size;
+}
+
+int SerialPort::get_capture_segment_size() const {
+	return capture_segment_size;
+}
+
+void SerialPort::set_capture_max_segments(int count) {
+	ERR_FAIL_COND(count < 0);
+	capture_max_segments = count;
+}
+
+int SerialPort::get_capture_max_segments() const {
+	return capture_max_segments;
+}
+
+void SerialPort::set_replay_speed(double speed) {
+	ERR_FAIL_COND(speed < 0.0);
+	replay_speed = speed;
+}
+
+double SerialPort::get_replay_speed() const {
+	return replay_speed;
+}
+
+void SerialPort::set_low_latency(bool enabled) {
+	low_latency = enabled;
+	if (!serial_open) {
+		return;
+	}
+	std::unique_lock<SerialPortLock> lock(link.get_lock());
+	if (enabled) {
+		low_latency_settings.enable(serial->getPort());
+	} else {
+		low_latency_settings.disable(serial->getPort());
+	}
+}
+
+bool SerialPort::is_low_latency() const {
+	return low_latency;
+}
+
+Dictionary SerialPort::get_low_latency_status() const {
+	const SerialLowLatency::Status &status = low_latency_settings.get_status();
+	Dictionary result;
+	result["async_low_latency"] = status.async_low_latency;
+	result["vmin_vtime"] = status.vmin_vtime;
+	result["latency_timer"] = status.latency_timer;
+	return result;
+}
+
+void SerialPort::set_auto_reconnect(bool enabled) {
+	if (enabled == auto_reconnect) {
+		return;
+	}
+	auto_reconnect = enabled;
+	SerialPortManager *manager = SerialPortManager::get_singleton();
+	ERR_FAIL_NULL(manager);
+	if (enabled) {
+		manager->start_watching_ports();
+		manager->connect("port_added", Callable(this, "_on_port_added"));
+		manager->connect("port_removed", Callable(this, "_on_port_removed"));
+	} else {
+		manager->disconnect("port_added", Callable(this, "_on_port_added"));
+		manager->disconnect("port_removed", Callable(this, "_on_port_removed"));
+		manager->stop_watching_ports();
+		reconnecting = false;
+	}
+}
+
+bool SerialPort::is_auto_reconnect() const {
+	return auto_reconnect;
+}
+
+void SerialPort::set_reconnect_min_delay(int msec) {
+	ERR_FAIL_COND(msec <= 0);
+	reconnect_min_delay = msec;
+}
+
+int SerialPort::get_reconnect_min_delay() const {
+	return reconnect_min_delay;
+}
+
+void SerialPort::set_reconnect_max_delay(int msec) {
+	ERR_FAIL_COND(msec <= 0);
+	reconnect_max_delay = msec;
+}
 
-using namespace std::chrono;
+int SerialPort::get_reconnect_max_delay() const {
+	return reconnect_max_delay;
+}
 
-void SerialPort::_data_received(const PackedByteArray &buf) {
-	emit_signal("data_received", buf);
+bool SerialPort::is_reconnecting() const {
+	return reconnecting;
 }
 
-SerialPort::SerialPort(const String &port, uint32_t baudrate, uint32_t timeout, ByteSize bytesize, Parity parity, StopBits stopbits, FlowControl flowcontrol) {
-	serial = new Serial(port.ascii().get_data(),
-			baudrate, Timeout::simpleTimeout(timeout), bytesize_t(bytesize), parity_t(parity), stopbits_t(stopbits), flowcontrol_t(flowcontrol));
+SerialPort::ConnectionState SerialPort::get_connection_state() const {
+	return ConnectionState(connection_state.load());
 }
 
-SerialPort::~SerialPort() {
-	close();
-	stop_monitoring();
-	delete serial;
+void SerialPort::set_error_retry_min_delay(int msec) {
+	ERR_FAIL_COND(msec <= 0);
+	error_retry_min_delay = msec;
 }
 
-Dictionary SerialPort::list_ports() {
-	std::vector<PortInfo> ports_info = serial::list_ports();
+int SerialPort::get_error_retry_min_delay() const {
+	return error_retry_min_delay;
+}
 
-	Dictionary info_dict;
-	for (PortInfo port : ports_info) {
-		Dictionary info;
-		info["desc"] = port.description.c_str();
-		info["hw_id"] = port.hardware_id.c_str();
-		info_dict[port.port.c_str()] = Variant(info);
-	}
+void SerialPort::set_error_retry_max_delay(int msec) {
+	ERR_FAIL_COND(msec <= 0);
+	error_retry_max_delay = msec;
+}
 
-	return info_dict;
+int SerialPort::get_error_retry_max_delay() const {
+	return error_retry_max_delay;
 }
 
-void SerialPort::_on_error(const String &where, const String &what) {
-	fine_working = false;
-	error_message = "[" + get_port() + "] Error at " + where + ": " + what;
-	// ERR_FAIL_MSG(error_message);
-	emit_signal("got_error", where, what);
+void SerialPort::set_error_failure_threshold(int count) {
+	ERR_FAIL_COND(count < 0);
+	error_failure_threshold = count;
 }
 
-Error SerialPort::start_monitoring(uint64_t interval_in_usec) {
-	ERR_FAIL_COND_V_MSG(!monitoring_should_exit, ERR_ALREADY_IN_USE, "Monitor already started.");
-	stop_monitoring();
-	monitoring_should_exit = false;
-	monitoring_interval = interval_in_usec;
-	thread = std::thread(_thread_func, this);
-	if (is_open()) {
-		fine_working = true;
-	} else {
-		fine_working = false;
+int SerialPort::get_error_failure_threshold() const {
+	return error_failure_threshold;
+}
+
+void SerialPort::set_error_signal_interval(int msec) {
+	ERR_FAIL_COND(msec < 0);
+	error_signal_interval = msec;
+}
+
+int SerialPort::get_error_signal_interval() const {
+	return error_signal_interval;
+}
+
+int64_t SerialPort::get_suppressed_error_count() const {
+	return suppressed_errors;
+}
+
+void SerialPort::_on_disconnected() {
+	disconnect_pending = false;
+	if (!auto_reconnect || reconnecting || !serial_open) {
+		return;
+	}
+	// Release the stale descriptor, the monitor idles until the next open().
+	close();
+	reconnecting = true;
+	reconnect_delay = reconnect_min_delay;
+	// A timer left from an earlier disconnection takes over instead.
+	if (!reconnect_timer_pending) {
+		_on_reconnect_timer();
+	}
+}
+
+void SerialPort::_on_reconnect_timer() {
+	reconnect_timer_pending = false;
+	if (!reconnecting || is_open()) {
+		return;
+	}
+	if (_device_exists(serial->getPort()) && open() == OK) {
+		reconnecting = false;
+		return;
 	}
 
-	return OK;
+	SceneTree *tree = _get_scene_tree();
+	ERR_FAIL_NULL(tree);
+	reconnect_timer_pending = true;
+	tree->create_timer(reconnect_delay / 1000.0)->connect("timeout", Callable(this, "_on_reconnect_timer"));
+	reconnect_delay = MIN(reconnect_delay * 2, reconnect_max_delay);
 }
 
-void SerialPort::stop_monitoring() {
-	monitoring_should_exit = true;
-	if (thread.joinable()) {
-		thread.join();
+void SerialPort::_on_port_added(const String &port) {
+	// Aliases like /dev/serial/by-id/... are reported under their target, so
+	// any new port is a reason to look for ours. Failures are left to the timer.
+	if (reconnecting && _device_exists(serial->getPort()) && open() == OK) {
+		reconnecting = false;
+	}
+}
+
+void SerialPort::_on_port_removed(const String &port) {
+	if (serial_open && !_device_exists(serial->getPort())) {
+		_on_disconnected();
 	}
 }
 
-void SerialPort::_thread_func(void *p_user_data) {
+void SerialPort::_on_replay_finished(void *p_user_data) {
 	SerialPort *serial_port = static_cast<SerialPort *>(p_user_data);
-	while (!serial_port->monitoring_should_exit) {
-		time_point time_start = system_clock::now();
+	serial_port->call_deferred("_replay_finished");
+}
 
-		if (serial_port->fine_working) {
-			if (serial_port->is_open() && serial_port->available() > 0) {
-				serial_port->call_deferred("_data_received", serial_port->read_raw(serial_port->available()));
-			}
-		}
-		time_t time_elapsed = duration_cast<microseconds>(system_clock::now() - time_start).count();
-		if (time_elapsed < serial_port->monitoring_interval) {
-			std::this_thread::sleep_for(microseconds(serial_port->monitoring_interval - time_elapsed));
-		}
+void SerialPort::_replay_finished() {
+	emit_signal("replay_finished");
+}
+
+bool SerialPort::_link_can_read(void *p_user_data) {
+	return static_cast<SerialPort *>(p_user_data)->_attempt_allowed(__FUNCTION__);
+}
+
+int64_t SerialPort::_link_get_retry_delay(void *p_user_data) {
+	return static_cast<SerialPort *>(p_user_data)->_retry_delay_usec();
+}
+
+int SerialPort::_link_open_fd(void *p_user_data) {
+#ifdef SERIAL_PORT_EVENT_MONITOR
+	return static_cast<SerialPort *>(p_user_data)->_open_rx_fd();
+#else
+	return -1;
+#endif
+}
+
+void SerialPort::_link_receive(void *p_user_data, uint64_t p_readable_at) {
+	static_cast<SerialPort *>(p_user_data)->_receive(SIZE_MAX, p_readable_at);
+}
+
+void SerialPort::_link_on_error(void *p_user_data, const char *p_where, const char *p_what) {
+	static_cast<SerialPort *>(p_user_data)->_on_io_error(p_where, p_what);
+}
+
+#ifdef SERIAL_PORT_EVENT_MONITOR
+void SerialPort::_wakeup_monitor() {
+	if (monitoring_shared) {
+		SerialPortManager::get_singleton()->wakeup(this);
+	} else {
+		link.wakeup();
 	}
 }
 
+int SerialPort::_open_rx_fd() {
+	// A second descriptor on the same tty shares its input queue, so it becomes
+	// readable exactly when `serial` has data, without reaching into its internals.
+	int fd = replay.is_open() ? dup(replay.get_readable_fd()) : ::open(get_port().utf8().get_data(), O_RDONLY | O_NOCTTY | O_NONBLOCK);
+	if (fd < 0) {
+		_on_io_error(__FUNCTION__, strerror(errno));
+	}
+	return fd;
+}
+#endif
+
 Error SerialPort::open(String port) {
-	error_message = "";
+	{
+		std::lock_guard<std::mutex> lock(error_mutex);
+		error_message = "";
+	}
+	clear_buffered();
 	try {
-		if (serial->isOpen()) {
+		if (is_open()) {
 			close();
 		}
 		if (!port.is_empty()) {
 			set_port(port);
 		}
-		serial->open();
+		String name = get_port();
+		String replay_path;
+		if (name.begins_with("replay://")) {
+			replay_path = ProjectSettings::get_singleton()->globalize_path(name.trim_prefix("replay://"));
+		}
+		bool opened = link.open([&]() {
+			if (!replay_path.is_empty()) {
+				return replay.open(replay_path.utf8().get_data(), replay_speed, _on_replay_finished, this);
+			}
+			serial->open();
+			serial_open = true;
+			if (low_latency) {
+				low_latency_settings.enable(serial->getPort());
+			}
+			return true;
+		});
+		if (!opened) {
+			_on_error(__FUNCTION__, "Can't read capture file: " + replay_path);
+			return ERR_CANT_OPEN;
+		}
 	} catch (IOException &e) {
 		_on_error(__FUNCTION__, e.what());
 		return ERR_CANT_OPEN;
@@ -143,18 +1886,33 @@ Error SerialPort::open(String port) {
 		return FAILED;
 	}
 
-	fine_working = true;
+	_recover();
+#ifdef SERIAL_PORT_EVENT_MONITOR
+	// The link wakes its own monitor, the manager's reactor needs telling.
+	if (monitoring_shared) {
+		_wakeup_monitor();
+	}
+#endif
 	emit_signal("opened", port);
 	return OK;
 }
 
 bool SerialPort::is_open() const {
-	return serial->isOpen();
+	return link.is_open();
 }
 
 void SerialPort::close() {
+	reconnecting = false;
+	_stop_writer();
 	try {
-		serial->close();
+		link.close([&]() {
+			replay.close();
+			if (serial_open) {
+				low_latency_settings.disable(serial->getPort());
+			}
+			serial_open = false;
+			serial->close();
+		});
 	} catch (IOException &e) {
 		_on_error(__FUNCTION__, e.what());
 	} catch (SerialException &e) {
@@ -163,26 +1921,56 @@ void SerialPort::close() {
 		_on_error(__FUNCTION__, "Unknown error");
 	}
 
-	fine_working = false;
-	emit_signal("closed", serial->getPort().c_str());
+	consecutive_errors = 0;
+	_set_connection_state(CONNECTION_OK);
+	_cancel_read_requests();
+#ifdef SERIAL_PORT_EVENT_MONITOR
+	if (monitoring_shared) {
+		_wakeup_monitor();
+	}
+#endif
+	emit_signal("closed", get_port());
 }
 
-size_t SerialPort::available() {
+size_t SerialPort::_available(const char *where) {
+	if (replay.is_open()) {
+		return replay.available();
+	}
+	if (!_attempt_allowed(where)) {
+		return 0;
+	}
 	try {
-		return serial->available();
+		return link.io([&]() {
+			size_t size = serial->available();
+			if (connection_state != CONNECTION_OK) {
+				_recover();
+			}
+			return size;
+		});
 	} catch (IOException &e) {
-		_on_error(__FUNCTION__, e.what());
+		_on_io_error(where, e.what());
 	} catch (SerialException &e) {
-		_on_error(__FUNCTION__, e.what());
+		_on_io_error(where, e.what());
 	} catch (...) {
-		_on_error(__FUNCTION__, "Unknown error");
+		_on_io_error(where, "Unknown error");
 	}
 
 	return 0;
 }
 
+size_t SerialPort::available() {
+	return line_reader.get_buffered() + _available(__FUNCTION__);
+}
+
 bool SerialPort::wait_readable() {
+	if (line_reader.get_buffered() > 0) {
+		return true;
+	}
+	if (replay.is_open()) {
+		return replay.wait_readable(get_timeout());
+	}
 	try {
+		std::shared_lock<SerialPortLock> lock(link.get_lock());
 		return serial->waitReadable();
 	} catch (IOException &e) {
 		_on_error(__FUNCTION__, e.what());
@@ -197,6 +1985,7 @@ bool SerialPort::wait_readable() {
 
 void SerialPort::wait_byte_times(size_t count) {
 	try {
+		std::shared_lock<SerialPortLock> lock(link.get_lock());
 		serial->waitByteTimes(count);
 	} catch (IOException &e) {
 		_on_error(__FUNCTION__, e.what());
@@ -207,145 +1996,365 @@ void SerialPort::wait_byte_times(size_t count) {
 	}
 }
 
-PackedByteArray SerialPort::read_raw(size_t size) {
-	PackedByteArray raw;
-	std::vector<uint8_t> buf_temp;
+size_t SerialPort::_read_bytes(uint8_t *buffer, size_t size, const char *where) {
+	SerialPortStats::add(stats.read_calls);
+	if (!_attempt_allowed(where)) {
+		return 0;
+	}
+	uint32_t timeout = get_timeout();
 	try {
-		size_t bytes_read = serial->read(buf_temp, size);
-		if (bytes_read > 0 && raw.resize(bytes_read) == OK) {
-			memcpy(raw.ptrw(), (const char *)buf_temp.data(), bytes_read);
-		}
+		return link.io([&]() {
+			size_t bytes_read = replay.is_open() ? replay.read(buffer, size, timeout) : serial->read(buffer, size);
+			if (connection_state != CONNECTION_OK) {
+				_recover();
+			}
+			if (bytes_read > 0) {
+				SerialPortStats::add(stats.rx_bytes, bytes_read);
+				SerialPortStats::add(stats.rx_chunks);
+				capture.append(SerialCapture::DIRECTION_RX, buffer, bytes_read);
+			}
+			return bytes_read;
+		});
 	} catch (PortNotOpenedException &e) {
-		_on_error(__FUNCTION__, e.what());
+		_on_io_error(where, e.what());
 	} catch (IOException &e) {
-		_on_error(__FUNCTION__, e.what());
+		_on_io_error(where, e.what());
 	} catch (SerialException &e) {
-		_on_error(__FUNCTION__, e.what());
+		_on_io_error(where, e.what());
 	} catch (...) {
-		_on_error(__FUNCTION__, "Unknown error");
+		_on_io_error(where, "Unknown error");
+	}
+
+	return 0;
+}
+
+size_t SerialPort::_read_buffered(uint8_t *buffer, size_t size, const char *where) {
+	return line_reader.read(buffer, size, [&](uint8_t *p_buffer, size_t p_size) {
+		return _read_bytes(p_buffer, p_size, where);
+	});
+}
+
+size_t SerialPort::_buffer_line(size_t max_length, const CharString &eol, const char *where) {
+	return line_reader.buffer_line(
+			max_length, (const uint8_t *)eol.get_data(), eol.length(),
+			[&]() {
+				return _available(where);
+			},
+			[&](uint8_t *p_buffer, size_t p_size) {
+				return _read_bytes(p_buffer, p_size, where);
+			});
+}
+
+PackedByteArray SerialPort::read_raw(size_t size) {
+	PackedByteArray raw;
+	if (size > 0 && raw.resize(size) == OK) {
+		raw.resize(_read_buffered(raw.ptrw(), size, __FUNCTION__));
 	}
 
 	return raw;
 }
 
+int SerialPort::read_into(const Ref<StreamPeerBuffer> &buffer, int size) {
+	ERR_FAIL_COND_V(buffer.is_null(), 0);
+	ERR_FAIL_COND_V(size < 0, 0);
+	// Reused per thread, so steady-state reads don't allocate.
+	thread_local std::vector<uint8_t> scratch;
+	if (scratch.size() < size_t(size)) {
+		scratch.resize(size);
+	}
+	size_t bytes_read = _read_buffered(scratch.data(), size, __FUNCTION__);
+	_put_bytes(buffer, scratch.data(), bytes_read);
+	return bytes_read;
+}
+
 String SerialPort::read_str(size_t size, bool utf8_encoding) {
+	std::vector<uint8_t> buf_temp(size);
+	size_t bytes_read = _read_buffered(buf_temp.data(), size, __FUNCTION__);
+	return _bytes_to_string(buf_temp.data(), strnlen((const char *)buf_temp.data(), bytes_read), utf8_encoding);
+}
+
+size_t SerialPort::_write_bytes(const uint8_t *data, size_t size, const char *where, Error *r_error) {
+	SerialPortStats::add(stats.write_calls);
+	if (!_attempt_allowed(where)) {
+		if (r_error) {
+			*r_error = ERR_UNAVAILABLE;
+		}
+		return 0;
+	}
 	try {
-		String str;
-		std::vector<uint8_t> buf_temp;
-		size_t bytes_read = serial->read(buf_temp, size);
-		buf_temp.insert(buf_temp.end(), '\0');
-		if (bytes_read > 0) {
-			if (utf8_encoding) {
-				str.parse_utf8((const char *)buf_temp.data(), bytes_read);
-			} else {
-				str = (const char *)buf_temp.data();
+		size_t written = link.io([&]() {
+			// Nothing listens to a replay, writes are dropped.
+			size_t written = replay.is_open() ? size : serial->write(data, size);
+			if (connection_state != CONNECTION_OK) {
+				_recover();
+			}
+			if (written > 0) {
+				SerialPortStats::add(stats.tx_bytes, written);
+				SerialPortStats::add(stats.tx_chunks);
+				capture.append(SerialCapture::DIRECTION_TX, data, written);
 			}
+			return written;
+		});
+		// close() may have won the race for the lock.
+		if (written == 0 && !is_open() && r_error) {
+			*r_error = ERR_UNAVAILABLE;
 		}
-		return str;
+		return written;
 	} catch (PortNotOpenedException &e) {
-		_on_error(__FUNCTION__, e.what());
+		_on_io_error(where, e.what());
 	} catch (IOException &e) {
-		_on_error(__FUNCTION__, e.what());
+		_on_io_error(where, e.what());
 	} catch (SerialException &e) {
-		_on_error(__FUNCTION__, e.what());
+		_on_io_error(where, e.what());
 	} catch (...) {
-		_on_error(__FUNCTION__, "Unknown error");
+		_on_io_error(where, "Unknown error");
 	}
 
-	return "";
+	if (r_error) {
+		*r_error = FAILED;
+	}
+	return 0;
 }
 
 size_t SerialPort::write_raw(const PackedByteArray &data) {
-	try {
-		return serial->write(data.ptr(), data.size());
-	} catch (PortNotOpenedException &e) {
-		_on_error(__FUNCTION__, e.what());
-	} catch (IOException &e) {
-		_on_error(__FUNCTION__, e.what());
-	} catch (SerialException &e) {
-		_on_error(__FUNCTION__, e.what());
-	} catch (...) {
-		_on_error(__FUNCTION__, "Unknown error");
-	}
-
-	return 0;
+	PackedByteArray frame = _with_checksum(data);
+	return _write_bytes(frame.ptr(), frame.size(), __FUNCTION__);
 }
 
 size_t SerialPort::write_str(const String &data, bool utf8_encoding) {
-	try {
-		if (utf8_encoding) {
-			CharString str = data.utf8();
-			return serial->write((const uint8_t *)(str.get_data()), str.length());
+	CharString str = utf8_encoding ? data.utf8() : data.ascii();
+	return _write_bytes((const uint8_t *)(str.get_data()), str.length(), __FUNCTION__);
+}
+
+int64_t SerialPort::write_async(const PackedByteArray &data) {
+	ERR_FAIL_COND_V_MSG(!is_open(), 0, "Port not open.");
+	if (data.is_empty()) {
+		return 0;
+	}
+	PackedByteArray frame = _with_checksum(data);
+
+	int64_t id;
+	{
+		std::lock_guard<std::mutex> lock(tx_mutex);
+		if (tx_queued_bytes + frame.size() > size_t(tx_queue_capacity)) {
+			tx_full = true;
+			id = 0;
 		} else {
-			CharString str = data.ascii();
-			return serial->write((const uint8_t *)(str.get_data()), str.length());
+			id = ++tx_last_id;
+			tx_queue.push_back({ uint64_t(id), frame });
+			tx_queued_bytes += frame.size();
+			SerialPortStats::update_max(stats.tx_queue_high_water, tx_queued_bytes);
 		}
-	} catch (PortNotOpenedException &e) {
-		_on_error(__FUNCTION__, e.what());
-	} catch (IOException &e) {
-		_on_error(__FUNCTION__, e.what());
-	} catch (SerialException &e) {
-		_on_error(__FUNCTION__, e.what());
-	} catch (...) {
-		_on_error(__FUNCTION__, "Unknown error");
+	}
+	if (id == 0) {
+		emit_signal("tx_queue_full");
+		return 0;
 	}
 
-	return 0;
+	if (!tx_thread.joinable()) {
+		tx_thread = std::thread(_tx_thread_func, this);
+	}
+	tx_cond.notify_one();
+	return id;
 }
 
-String SerialPort::read_line(size_t max_length, String eol, bool utf8_encoding) {
-	try {
-		if (utf8_encoding) {
-			String str;
-			str.parse_utf8(serial->readline(max_length, eol.utf8().get_data()).c_str());
-			return str;
-		} else {
-			return serial->readline(max_length, eol.ascii().get_data()).c_str();
+int SerialPort::get_tx_queued_bytes() {
+	std::lock_guard<std::mutex> lock(tx_mutex);
+	return tx_queued_bytes;
+}
+
+void SerialPort::set_tx_queue_capacity(int capacity) {
+	ERR_FAIL_COND(capacity <= 0);
+	tx_queue_capacity = capacity;
+}
+
+int SerialPort::get_tx_queue_capacity() const {
+	return tx_queue_capacity;
+}
+
+void SerialPort::set_tx_queue_low_watermark(int size) {
+	ERR_FAIL_COND(size < 0);
+	tx_queue_low_watermark = size;
+}
+
+int SerialPort::get_tx_queue_low_watermark() const {
+	return tx_queue_low_watermark;
+}
+
+void SerialPort::set_tx_pacing_rate(double rate) {
+	ERR_FAIL_COND_MSG(rate < 0.0 || rate > 1.0, "Pacing rate is a fraction of the line rate, between 0 and 1.");
+	{
+		std::lock_guard<std::mutex> lock(tx_mutex);
+		tx_pacer.set_rate(rate);
+		tx_pacer.reset();
+	}
+	tx_cond.notify_one();
+}
+
+double SerialPort::get_tx_pacing_rate() const {
+	std::lock_guard<std::mutex> lock(tx_mutex);
+	return tx_pacer.get_rate();
+}
+
+void SerialPort::set_tx_pacing_burst(int size) {
+	ERR_FAIL_COND(size < 1);
+	{
+		std::lock_guard<std::mutex> lock(tx_mutex);
+		tx_pacer.set_burst(size);
+		tx_pacer.reset();
+	}
+	tx_cond.notify_one();
+}
+
+int SerialPort::get_tx_pacing_burst() const {
+	std::lock_guard<std::mutex> lock(tx_mutex);
+	return tx_pacer.get_burst();
+}
+
+void SerialPort::set_tx_pacing_gap(int usec) {
+	ERR_FAIL_COND(usec < 0);
+	{
+		std::lock_guard<std::mutex> lock(tx_mutex);
+		tx_pacer.set_gap_usec(usec);
+		tx_pacer.reset();
+	}
+	tx_cond.notify_one();
+}
+
+int SerialPort::get_tx_pacing_gap() const {
+	std::lock_guard<std::mutex> lock(tx_mutex);
+	return tx_pacer.get_gap_usec();
+}
+
+double SerialPort::get_line_rate() const {
+	double byte_usec = _get_byte_time_usec();
+	return byte_usec > 0.0 ? 1000000.0 / byte_usec : 0.0;
+}
+
+Error SerialPort::transact(int64_t id, const PackedByteArray &request, int timeout_ms, int retries) {
+	ERR_FAIL_COND_V_MSG(!is_open(), ERR_UNCONFIGURED, "Port not open.");
+	ERR_FAIL_COND_V_MSG(monitoring_should_exit || !framing_enabled, ERR_UNCONFIGURED, "Responses are matched to framed packets, start monitoring with a framing mode first.");
+	ERR_FAIL_COND_V(request.is_empty(), ERR_INVALID_PARAMETER);
+	ERR_FAIL_COND_V(timeout_ms <= 0 || retries < 0, ERR_INVALID_PARAMETER);
+	PackedByteArray frame = _with_checksum(request);
+
+	bool submitted;
+	{
+		std::lock_guard<std::mutex> lock(tx_mutex);
+		submitted = transactions.submit(id, frame.ptr(), frame.size(), uint64_t(timeout_ms) * 1000, retries);
+	}
+	ERR_FAIL_COND_V_MSG(!submitted, ERR_ALREADY_IN_USE, "A transaction with this ID is still pending.");
+
+	if (!tx_thread.joinable()) {
+		tx_thread = std::thread(_tx_thread_func, this);
+	}
+	tx_cond.notify_one();
+	return OK;
+}
+
+void SerialPort::cancel_transactions() {
+	size_t pending;
+	{
+		std::lock_guard<std::mutex> lock(tx_mutex);
+		pending = transactions.get_in_flight_count() + transactions.get_waiting_count();
+		transactions.cancel(transaction_completions);
+		transactions_active = false;
+		stats.transactions_in_flight = 0;
+		if (pending > 0) {
+			_notify_transactions();
 		}
-	} catch (PortNotOpenedException &e) {
-		_on_error(__FUNCTION__, e.what());
-	} catch (IOException &e) {
-		_on_error(__FUNCTION__, e.what());
-	} catch (SerialException &e) {
-		_on_error(__FUNCTION__, e.what());
-	} catch (...) {
-		_on_error(__FUNCTION__, "Unknown error");
 	}
+	SerialPortStats::add(stats.transactions_failed, pending);
+}
+
+int SerialPort::get_transactions_in_flight() const {
+	std::lock_guard<std::mutex> lock(tx_mutex);
+	return transactions.get_in_flight_count();
+}
+
+int SerialPort::get_transactions_waiting() const {
+	std::lock_guard<std::mutex> lock(tx_mutex);
+	return transactions.get_waiting_count();
+}
+
+void SerialPort::set_max_transactions_in_flight(int count) {
+	ERR_FAIL_COND(count < 1);
+	{
+		std::lock_guard<std::mutex> lock(tx_mutex);
+		transactions.set_max_in_flight(count);
+	}
+	tx_cond.notify_one();
+}
+
+int SerialPort::get_max_transactions_in_flight() const {
+	std::lock_guard<std::mutex> lock(tx_mutex);
+	return transactions.get_max_in_flight();
+}
+
+void SerialPort::set_transaction_id_offset(int offset) {
+	ERR_FAIL_COND(offset < 0);
+	std::lock_guard<std::mutex> lock(tx_mutex);
+	transactions.set_id_field(offset, transactions.get_id_field_size(), transactions.is_id_field_big_endian());
+}
+
+int SerialPort::get_transaction_id_offset() const {
+	std::lock_guard<std::mutex> lock(tx_mutex);
+	return transactions.get_id_field_offset();
+}
+
+void SerialPort::set_transaction_id_size(int size) {
+	ERR_FAIL_COND_MSG(size < 1 || size > 8, "Transaction ID size must be between 1 and 8 bytes.");
+	std::lock_guard<std::mutex> lock(tx_mutex);
+	transactions.set_id_field(transactions.get_id_field_offset(), size, transactions.is_id_field_big_endian());
+}
+
+int SerialPort::get_transaction_id_size() const {
+	std::lock_guard<std::mutex> lock(tx_mutex);
+	return transactions.get_id_field_size();
+}
+
+void SerialPort::set_transaction_id_big_endian(bool big_endian) {
+	std::lock_guard<std::mutex> lock(tx_mutex);
+	transactions.set_id_field(transactions.get_id_field_offset(), transactions.get_id_field_size(), big_endian);
+}
+
+bool SerialPort::is_transaction_id_big_endian() const {
+	std::lock_guard<std::mutex> lock(tx_mutex);
+	return transactions.is_id_field_big_endian();
+}
 
-	return "";
+String SerialPort::read_line(size_t max_length, String eol, bool utf8_encoding) {
+	CharString eol_chars = utf8_encoding ? eol.utf8() : eol.ascii();
+	size_t size = _buffer_line(max_length, eol_chars, __FUNCTION__);
+	String line = _bytes_to_string(line_reader.get_data(), size, utf8_encoding);
+	line_reader.consume(size);
+	return line;
 }
 
 PackedStringArray SerialPort::read_lines(size_t max_length, String eol, bool utf8_encoding) {
-	try {
-		PackedStringArray lines;
-		if (utf8_encoding) {
-			for (std::string line : serial->readlines(max_length, eol.utf8().get_data())) {
-				String str;
-				str.parse_utf8(line.c_str());
-				lines.append(str);
-			}
-			return lines;
-		} else {
-			for (std::string line : serial->readlines(max_length, eol.utf8().get_data())) {
-				lines.append(line.c_str());
-			}
-			return lines;
+	CharString eol_chars = utf8_encoding ? eol.utf8() : eol.ascii();
+	PackedStringArray lines;
+	size_t total = 0;
+	while (total < max_length) {
+		size_t size = _buffer_line(max_length - total, eol_chars, __FUNCTION__);
+		if (size == 0) {
+			break;
+		}
+		const uint8_t *line = line_reader.get_data();
+		lines.append(_bytes_to_string(line, size, utf8_encoding));
+		line_reader.consume(size);
+		total += size;
+		// A line without eol means the read timed out.
+		if (size < size_t(eol_chars.length()) || memcmp(line + size - eol_chars.length(), eol_chars.get_data(), eol_chars.length()) != 0) {
+			break;
 		}
-	} catch (PortNotOpenedException &e) {
-		_on_error(__FUNCTION__, e.what());
-	} catch (IOException &e) {
-		_on_error(__FUNCTION__, e.what());
-	} catch (SerialException &e) {
-		_on_error(__FUNCTION__, e.what());
-	} catch (...) {
-		_on_error(__FUNCTION__, "Unknown error");
 	}
-
-	return PackedStringArray();
+	return lines;
 }
 
 Error SerialPort::set_port(const String &port) {
 	try {
+		std::unique_lock<SerialPortLock> lock(link.get_lock());
 		serial->setPort(port.ascii().get_data());
 		return OK;
 	} catch (IOException &e) {
@@ -366,20 +2375,24 @@ Error SerialPort::set_port(const String &port) {
 }
 
 String SerialPort::get_port() const {
+	std::shared_lock<SerialPortLock> lock(link.get_lock());
 	return serial->getPort().c_str();
 }
 
 Error SerialPort::set_timeout(uint32_t timeout) {
+	std::unique_lock<SerialPortLock> lock(link.get_lock());
 	serial->setTimeout(Timeout::max(), timeout, 0, timeout, 0);
 	return OK;
 }
 
 uint32_t SerialPort::get_timeout() const {
+	std::shared_lock<SerialPortLock> lock(link.get_lock());
 	return serial->getTimeout().read_timeout_constant;
 }
 
 Error SerialPort::set_baudrate(uint32_t baudrate) {
 	try {
+		std::unique_lock<SerialPortLock> lock(link.get_lock());
 		serial->setBaudrate(baudrate);
 		return OK;
 	} catch (IOException &e) {
@@ -394,11 +2407,13 @@ Error SerialPort::set_baudrate(uint32_t baudrate) {
 }
 
 uint32_t SerialPort::get_baudrate() const {
+	std::shared_lock<SerialPortLock> lock(link.get_lock());
 	return serial->getBaudrate();
 }
 
 Error SerialPort::set_bytesize(ByteSize bytesize) {
 	try {
+		std::unique_lock<SerialPortLock> lock(link.get_lock());
 		serial->setBytesize(bytesize_t(bytesize));
 		return OK;
 	} catch (IOException &e) {
@@ -413,11 +2428,13 @@ Error SerialPort::set_bytesize(ByteSize bytesize) {
 }
 
 SerialPort::ByteSize SerialPort::get_bytesize() const {
+	std::shared_lock<SerialPortLock> lock(link.get_lock());
 	return ByteSize(serial->getBytesize());
 }
 
 Error SerialPort::set_parity(Parity parity) {
 	try {
+		std::unique_lock<SerialPortLock> lock(link.get_lock());
 		serial->setParity(parity_t(parity));
 		return OK;
 	} catch (IOException &e) {
@@ -432,11 +2449,13 @@ Error SerialPort::set_parity(Parity parity) {
 }
 
 SerialPort::Parity SerialPort::get_parity() const {
+	std::shared_lock<SerialPortLock> lock(link.get_lock());
 	return Parity(serial->getParity());
 }
 
 Error SerialPort::set_stopbits(StopBits stopbits) {
 	try {
+		std::unique_lock<SerialPortLock> lock(link.get_lock());
 		serial->setStopbits(stopbits_t(stopbits));
 		return OK;
 	} catch (IOException &e) {
@@ -451,11 +2470,13 @@ Error SerialPort::set_stopbits(StopBits stopbits) {
 }
 
 SerialPort::StopBits SerialPort::get_stopbits() const {
+	std::shared_lock<SerialPortLock> lock(link.get_lock());
 	return StopBits(serial->getStopbits());
 }
 
 Error SerialPort::set_flowcontrol(FlowControl flowcontrol) {
 	try {
+		std::unique_lock<SerialPortLock> lock(link.get_lock());
 		serial->setFlowcontrol(flowcontrol_t(flowcontrol));
 		return OK;
 	} catch (IOException &e) {
@@ -470,11 +2491,16 @@ Error SerialPort::set_flowcontrol(FlowControl flowcontrol) {
 }
 
 SerialPort::FlowControl SerialPort::get_flowcontrol() const {
+	std::shared_lock<SerialPortLock> lock(link.get_lock());
 	return FlowControl(serial->getFlowcontrol());
 }
 
 Error SerialPort::flush() {
+	if (replay.is_open()) {
+		return OK;
+	}
 	try {
+		std::shared_lock<SerialPortLock> lock(link.get_lock());
 		serial->flush();
 		return OK;
 	} catch (PortNotOpenedException &e) {
@@ -487,7 +2513,11 @@ Error SerialPort::flush() {
 }
 
 Error SerialPort::flush_input() {
+	if (replay.is_open()) {
+		return OK;
+	}
 	try {
+		std::shared_lock<SerialPortLock> lock(link.get_lock());
 		serial->flushInput();
 		return OK;
 	} catch (PortNotOpenedException &e) {
@@ -500,7 +2530,11 @@ Error SerialPort::flush_input() {
 }
 
 Error SerialPort::flush_output() {
+	if (replay.is_open()) {
+		return OK;
+	}
 	try {
+		std::shared_lock<SerialPortLock> lock(link.get_lock());
 		serial->flushOutput();
 		return OK;
 	} catch (PortNotOpenedException &e) {
@@ -514,6 +2548,7 @@ Error SerialPort::flush_output() {
 
 Error SerialPort::send_break(int duration) {
 	try {
+		std::shared_lock<SerialPortLock> lock(link.get_lock());
 		serial->sendBreak(duration);
 		return OK;
 	} catch (IOException &e) {
@@ -529,6 +2564,7 @@ Error SerialPort::send_break(int duration) {
 
 Error SerialPort::set_break(bool level) {
 	try {
+		std::shared_lock<SerialPortLock> lock(link.get_lock());
 		serial->setBreak(level);
 		return OK;
 	} catch (SerialException &e) {
@@ -544,6 +2580,7 @@ Error SerialPort::set_break(bool level) {
 
 Error SerialPort::set_rts(bool level) {
 	try {
+		std::shared_lock<SerialPortLock> lock(link.get_lock());
 		serial->setRTS(level);
 		return OK;
 	} catch (SerialException &e) {
@@ -559,6 +2596,7 @@ Error SerialPort::set_rts(bool level) {
 
 Error SerialPort::set_dtr(bool level) {
 	try {
+		std::shared_lock<SerialPortLock> lock(link.get_lock());
 		serial->setDTR(level);
 		return OK;
 	} catch (SerialException &e) {
@@ -572,8 +2610,27 @@ Error SerialPort::set_dtr(bool level) {
 }
 
 bool SerialPort::wait_for_change() {
+	// Serial::waitForChange() blocks without a time limit, under the lock
+	// that would stall close() forever. Poll the lines instead, holding the
+	// lock only for each sample.
 	try {
-		return serial->waitForChange();
+		int initial = -1;
+		while (is_open()) {
+			int lines;
+			{
+				std::shared_lock<SerialPortLock> lock(link.get_lock());
+				if (!is_open()) {
+					break;
+				}
+				lines = serial->getCTS() | serial->getDSR() << 1 | serial->getRI() << 2 | serial->getCD() << 3;
+			}
+			if (initial < 0) {
+				initial = lines;
+			} else if (lines != initial) {
+				return true;
+			}
+			std::this_thread::sleep_for(milliseconds(1));
+		}
 	} catch (SerialException &e) {
 		_on_error(__FUNCTION__, e.what());
 	} catch (PortNotOpenedException &e) {
@@ -587,6 +2644,7 @@ bool SerialPort::wait_for_change() {
 
 bool SerialPort::get_cts() {
 	try {
+		std::shared_lock<SerialPortLock> lock(link.get_lock());
 		return serial->getCTS();
 	} catch (IOException &e) {
 		_on_error(__FUNCTION__, e.what());
@@ -603,6 +2661,7 @@ bool SerialPort::get_cts() {
 
 bool SerialPort::get_dsr() {
 	try {
+		std::shared_lock<SerialPortLock> lock(link.get_lock());
 		return serial->getDSR();
 	} catch (IOException &e) {
 		_on_error(__FUNCTION__, e.what());
@@ -619,6 +2678,7 @@ bool SerialPort::get_dsr() {
 
 bool SerialPort::get_ri() {
 	try {
+		std::shared_lock<SerialPortLock> lock(link.get_lock());
 		return serial->getRI();
 	} catch (IOException &e) {
 		_on_error(__FUNCTION__, e.what());
@@ -635,6 +2695,7 @@ bool SerialPort::get_ri() {
 
 bool SerialPort::get_cd() {
 	try {
+		std::shared_lock<SerialPortLock> lock(link.get_lock());
 		return serial->getCD();
 	} catch (IOException &e) {
 		_on_error(__FUNCTION__, e.what());
@@ -663,12 +2724,136 @@ String SerialPort::_to_string() const {
 void SerialPort::_bind_methods() {
 	ClassDB::bind_static_method("SerialPort", D_METHOD("list_ports"), &SerialPort::list_ports);
 
-	ClassDB::bind_method(D_METHOD("_data_received", "data"), &SerialPort::_data_received);
+	ClassDB::bind_method(D_METHOD("_data_received"), &SerialPort::_data_received);
+	ClassDB::bind_method(D_METHOD("_on_error_deferred", "where", "what"), &SerialPort::_on_error_deferred);
+	ClassDB::bind_method(D_METHOD("_read_requests_completed"), &SerialPort::_read_requests_completed);
+	ClassDB::bind_method(D_METHOD("_transactions_completed"), &SerialPort::_transactions_completed);
+	ClassDB::bind_method(D_METHOD("_process_packet", "processor", "sequence", "data"), &SerialPort::_process_packet);
+	ClassDB::bind_method(D_METHOD("_processing_completed"), &SerialPort::_processing_completed);
+	ClassDB::bind_method(D_METHOD("_read_request_timed_out", "request"), &SerialPort::_read_request_timed_out);
+	ClassDB::bind_method(D_METHOD("_flush_batch"), &SerialPort::_flush_batch);
+	ClassDB::bind_method(D_METHOD("_packets_received"), &SerialPort::_packets_received);
+	ClassDB::bind_method(D_METHOD("_records_received"), &SerialPort::_records_received);
+	ClassDB::bind_method(D_METHOD("_bad_packets_received"), &SerialPort::_bad_packets_received);
+	ClassDB::bind_method(D_METHOD("_tx_progress"), &SerialPort::_tx_progress);
+	ClassDB::bind_method(D_METHOD("_get_stat", "name"), &SerialPort::_get_stat);
 	ClassDB::bind_method(D_METHOD("is_in_error"), &SerialPort::is_in_error);
 	ClassDB::bind_method(D_METHOD("get_last_error"), &SerialPort::get_last_error);
 
 	ClassDB::bind_method(D_METHOD("start_monitoring", "interval_in_usec"), &SerialPort::start_monitoring, DEFVAL(10000));
 	ClassDB::bind_method(D_METHOD("stop_monitoring"), &SerialPort::stop_monitoring);
+	ClassDB::bind_method(D_METHOD("set_monitoring_mode", "mode"), &SerialPort::set_monitoring_mode);
+	ClassDB::bind_method(D_METHOD("get_monitoring_mode"), &SerialPort::get_monitoring_mode);
+	ClassDB::bind_method(D_METHOD("set_rx_buffer_capacity", "capacity"), &SerialPort::set_rx_buffer_capacity);
+	ClassDB::bind_method(D_METHOD("get_rx_buffer_capacity"), &SerialPort::get_rx_buffer_capacity);
+	ClassDB::bind_method(D_METHOD("set_manual_drain", "enabled"), &SerialPort::set_manual_drain);
+	ClassDB::bind_method(D_METHOD("is_manual_drain"), &SerialPort::is_manual_drain);
+
+	ClassDB::bind_method(D_METHOD("set_batch_mode", "mode"), &SerialPort::set_batch_mode);
+	ClassDB::bind_method(D_METHOD("get_batch_mode"), &SerialPort::get_batch_mode);
+	ClassDB::bind_method(D_METHOD("set_batch_size_threshold", "size"), &SerialPort::set_batch_size_threshold);
+	ClassDB::bind_method(D_METHOD("get_batch_size_threshold"), &SerialPort::get_batch_size_threshold);
+	ClassDB::bind_method(D_METHOD("set_batch_latency_threshold", "usec"), &SerialPort::set_batch_latency_threshold);
+	ClassDB::bind_method(D_METHOD("get_batch_latency_threshold"), &SerialPort::get_batch_latency_threshold);
+	ClassDB::bind_method(D_METHOD("get_last_batch_size"), &SerialPort::get_last_batch_size);
+	ClassDB::bind_method(D_METHOD("get_last_batch_age"), &SerialPort::get_last_batch_age);
+	ClassDB::bind_method(D_METHOD("set_rx_timestamps", "enabled"), &SerialPort::set_rx_timestamps);
+	ClassDB::bind_method(D_METHOD("is_rx_timestamps"), &SerialPort::is_rx_timestamps);
+	ClassDB::bind_method(D_METHOD("get_buffered_timestamp"), &SerialPort::get_buffered_timestamp);
+
+	ClassDB::bind_method(D_METHOD("set_framing_mode", "mode"), &SerialPort::set_framing_mode);
+	ClassDB::bind_method(D_METHOD("get_framing_mode"), &SerialPort::get_framing_mode);
+	ClassDB::bind_method(D_METHOD("set_frame_delimiter", "delimiter"), &SerialPort::set_frame_delimiter);
+	ClassDB::bind_method(D_METHOD("get_frame_delimiter"), &SerialPort::get_frame_delimiter);
+	ClassDB::bind_method(D_METHOD("set_frame_length", "length"), &SerialPort::set_frame_length);
+	ClassDB::bind_method(D_METHOD("get_frame_length"), &SerialPort::get_frame_length);
+	ClassDB::bind_method(D_METHOD("set_length_field_offset", "offset"), &SerialPort::set_length_field_offset);
+	ClassDB::bind_method(D_METHOD("get_length_field_offset"), &SerialPort::get_length_field_offset);
+	ClassDB::bind_method(D_METHOD("set_length_field_size", "size"), &SerialPort::set_length_field_size);
+	ClassDB::bind_method(D_METHOD("get_length_field_size"), &SerialPort::get_length_field_size);
+	ClassDB::bind_method(D_METHOD("set_length_field_big_endian", "big_endian"), &SerialPort::set_length_field_big_endian);
+	ClassDB::bind_method(D_METHOD("is_length_field_big_endian"), &SerialPort::is_length_field_big_endian);
+	ClassDB::bind_method(D_METHOD("set_length_adjustment", "adjustment"), &SerialPort::set_length_adjustment);
+	ClassDB::bind_method(D_METHOD("get_length_adjustment"), &SerialPort::get_length_adjustment);
+	ClassDB::bind_method(D_METHOD("set_max_frame_size", "size"), &SerialPort::set_max_frame_size);
+	ClassDB::bind_method(D_METHOD("get_max_frame_size"), &SerialPort::get_max_frame_size);
+	ClassDB::bind_method(D_METHOD("get_available_packet_count"), &SerialPort::get_available_packet_count);
+	ClassDB::bind_method(D_METHOD("get_packet"), &SerialPort::get_packet);
+	ClassDB::bind_method(D_METHOD("get_packet_timestamp"), &SerialPort::get_packet_timestamp);
+	ClassDB::bind_method(D_METHOD("get_dropped_frames"), &SerialPort::get_dropped_frames);
+
+	ClassDB::bind_method(D_METHOD("set_checksum_type", "type"), &SerialPort::set_checksum_type);
+	ClassDB::bind_method(D_METHOD("get_checksum_type"), &SerialPort::get_checksum_type);
+	ClassDB::bind_method(D_METHOD("set_checksum_big_endian", "big_endian"), &SerialPort::set_checksum_big_endian);
+	ClassDB::bind_method(D_METHOD("is_checksum_big_endian"), &SerialPort::is_checksum_big_endian);
+	ClassDB::bind_method(D_METHOD("set_checksum_validate", "enabled"), &SerialPort::set_checksum_validate);
+	ClassDB::bind_method(D_METHOD("is_checksum_validate"), &SerialPort::is_checksum_validate);
+	ClassDB::bind_method(D_METHOD("set_checksum_append", "enabled"), &SerialPort::set_checksum_append);
+	ClassDB::bind_method(D_METHOD("is_checksum_append"), &SerialPort::is_checksum_append);
+	ClassDB::bind_method(D_METHOD("get_checksum_errors"), &SerialPort::get_checksum_errors);
+	ClassDB::bind_static_method("SerialPort", D_METHOD("compute_checksum", "type", "data"), &SerialPort::compute_checksum);
+
+	ClassDB::bind_method(D_METHOD("set_record_schema", "fields", "record_size"), &SerialPort::set_record_schema, DEFVAL(0));
+	ClassDB::bind_method(D_METHOD("get_record_schema"), &SerialPort::get_record_schema);
+	ClassDB::bind_method(D_METHOD("get_record_size"), &SerialPort::get_record_size);
+	ClassDB::bind_method(D_METHOD("get_available_record_count"), &SerialPort::get_available_record_count);
+	ClassDB::bind_method(D_METHOD("drain_records"), &SerialPort::drain_records);
+	ClassDB::bind_method(D_METHOD("get_dropped_records"), &SerialPort::get_dropped_records);
+	ClassDB::bind_method(D_METHOD("set_packet_processor", "processor"), &SerialPort::set_packet_processor);
+	ClassDB::bind_method(D_METHOD("get_packet_processor"), &SerialPort::get_packet_processor);
+	ClassDB::bind_method(D_METHOD("set_max_processing_tasks", "count"), &SerialPort::set_max_processing_tasks);
+	ClassDB::bind_method(D_METHOD("get_max_processing_tasks"), &SerialPort::get_max_processing_tasks);
+	ClassDB::bind_method(D_METHOD("get_processing_tasks"), &SerialPort::get_processing_tasks);
+	ClassDB::bind_method(D_METHOD("get_queued_processing"), &SerialPort::get_queued_processing);
+
+	ClassDB::bind_method(D_METHOD("get_buffered_bytes"), &SerialPort::get_buffered_bytes);
+	ClassDB::bind_method(D_METHOD("peek_buffered", "max_size"), &SerialPort::peek_buffered, DEFVAL(-1));
+	ClassDB::bind_method(D_METHOD("drain_buffered", "max_size"), &SerialPort::drain_buffered, DEFVAL(-1));
+	ClassDB::bind_method(D_METHOD("drain_into", "buffer", "max_size"), &SerialPort::drain_into, DEFVAL(-1));
+	ClassDB::bind_method(D_METHOD("clear_buffered"), &SerialPort::clear_buffered);
+	ClassDB::bind_method(D_METHOD("read_async", "size", "timeout_ms"), &SerialPort::read_async, DEFVAL(0));
+	ClassDB::bind_method(D_METHOD("read_until_async", "delimiter", "max_size", "timeout_ms"), &SerialPort::read_until_async, DEFVAL(4096), DEFVAL(0));
+
+	ClassDB::bind_method(D_METHOD("get_stats"), &SerialPort::get_stats);
+	ClassDB::bind_method(D_METHOD("reset_stats"), &SerialPort::reset_stats);
+	ClassDB::bind_method(D_METHOD("add_performance_monitors", "category"), &SerialPort::add_performance_monitors, DEFVAL(""));
+	ClassDB::bind_method(D_METHOD("remove_performance_monitors"), &SerialPort::remove_performance_monitors);
+
+	ClassDB::bind_method(D_METHOD("start_capture", "path"), &SerialPort::start_capture);
+	ClassDB::bind_method(D_METHOD("stop_capture"), &SerialPort::stop_capture);
+	ClassDB::bind_method(D_METHOD("is_capturing"), &SerialPort::is_capturing);
+	ClassDB::bind_method(D_METHOD("set_capture_segment_size", "size"), &SerialPort::set_capture_segment_size);
+	ClassDB::bind_method(D_METHOD("get_capture_segment_size"), &SerialPort::get_capture_segment_size);
+	ClassDB::bind_method(D_METHOD("set_capture_max_segments", "count"), &SerialPort::set_capture_max_segments);
+	ClassDB::bind_method(D_METHOD("get_capture_max_segments"), &SerialPort::get_capture_max_segments);
+	ClassDB::bind_method(D_METHOD("set_replay_speed", "speed"), &SerialPort::set_replay_speed);
+	ClassDB::bind_method(D_METHOD("get_replay_speed"), &SerialPort::get_replay_speed);
+	ClassDB::bind_method(D_METHOD("_replay_finished"), &SerialPort::_replay_finished);
+	ClassDB::bind_method(D_METHOD("set_low_latency", "enabled"), &SerialPort::set_low_latency);
+	ClassDB::bind_method(D_METHOD("is_low_latency"), &SerialPort::is_low_latency);
+	ClassDB::bind_method(D_METHOD("get_low_latency_status"), &SerialPort::get_low_latency_status);
+	ClassDB::bind_method(D_METHOD("set_auto_reconnect", "enabled"), &SerialPort::set_auto_reconnect);
+	ClassDB::bind_method(D_METHOD("is_auto_reconnect"), &SerialPort::is_auto_reconnect);
+	ClassDB::bind_method(D_METHOD("set_reconnect_min_delay", "msec"), &SerialPort::set_reconnect_min_delay);
+	ClassDB::bind_method(D_METHOD("get_reconnect_min_delay"), &SerialPort::get_reconnect_min_delay);
+	ClassDB::bind_method(D_METHOD("set_reconnect_max_delay", "msec"), &SerialPort::set_reconnect_max_delay);
+	ClassDB::bind_method(D_METHOD("get_reconnect_max_delay"), &SerialPort::get_reconnect_max_delay);
+	ClassDB::bind_method(D_METHOD("is_reconnecting"), &SerialPort::is_reconnecting);
+	ClassDB::bind_method(D_METHOD("get_connection_state"), &SerialPort::get_connection_state);
+	ClassDB::bind_method(D_METHOD("_connection_state_changed"), &SerialPort::_connection_state_changed);
+	ClassDB::bind_method(D_METHOD("set_error_retry_min_delay", "msec"), &SerialPort::set_error_retry_min_delay);
+	ClassDB::bind_method(D_METHOD("get_error_retry_min_delay"), &SerialPort::get_error_retry_min_delay);
+	ClassDB::bind_method(D_METHOD("set_error_retry_max_delay", "msec"), &SerialPort::set_error_retry_max_delay);
+	ClassDB::bind_method(D_METHOD("get_error_retry_max_delay"), &SerialPort::get_error_retry_max_delay);
+	ClassDB::bind_method(D_METHOD("set_error_failure_threshold", "count"), &SerialPort::set_error_failure_threshold);
+	ClassDB::bind_method(D_METHOD("get_error_failure_threshold"), &SerialPort::get_error_failure_threshold);
+	ClassDB::bind_method(D_METHOD("set_error_signal_interval", "msec"), &SerialPort::set_error_signal_interval);
+	ClassDB::bind_method(D_METHOD("get_error_signal_interval"), &SerialPort::get_error_signal_interval);
+	ClassDB::bind_method(D_METHOD("get_suppressed_error_count"), &SerialPort::get_suppressed_error_count);
+	ClassDB::bind_method(D_METHOD("_on_disconnected"), &SerialPort::_on_disconnected);
+	ClassDB::bind_method(D_METHOD("_on_reconnect_timer"), &SerialPort::_on_reconnect_timer);
+	ClassDB::bind_method(D_METHOD("_on_port_added", "port"), &SerialPort::_on_port_added);
+	ClassDB::bind_method(D_METHOD("_on_port_removed", "port"), &SerialPort::_on_port_removed);
 
 	ClassDB::bind_method(D_METHOD("open", "port"), &SerialPort::open, DEFVAL(""));
 	ClassDB::bind_method(D_METHOD("is_open"), &SerialPort::is_open);
@@ -680,7 +2865,33 @@ void SerialPort::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("read_str", "size", "utf8_encoding"), &SerialPort::read_str, DEFVAL(1), DEFVAL(false));
 	ClassDB::bind_method(D_METHOD("write_str", "content", "utf8_encoding"), &SerialPort::write_str, DEFVAL(false));
 	ClassDB::bind_method(D_METHOD("read_raw", "size"), &SerialPort::read_raw, DEFVAL(1));
+	ClassDB::bind_method(D_METHOD("read_into", "buffer", "size"), &SerialPort::read_into, DEFVAL(1));
 	ClassDB::bind_method(D_METHOD("write_raw", "data"), &SerialPort::write_raw);
+	ClassDB::bind_method(D_METHOD("write_async", "data"), &SerialPort::write_async);
+	ClassDB::bind_method(D_METHOD("get_tx_queued_bytes"), &SerialPort::get_tx_queued_bytes);
+	ClassDB::bind_method(D_METHOD("set_tx_queue_capacity", "capacity"), &SerialPort::set_tx_queue_capacity);
+	ClassDB::bind_method(D_METHOD("get_tx_queue_capacity"), &SerialPort::get_tx_queue_capacity);
+	ClassDB::bind_method(D_METHOD("set_tx_queue_low_watermark", "size"), &SerialPort::set_tx_queue_low_watermark);
+	ClassDB::bind_method(D_METHOD("get_tx_queue_low_watermark"), &SerialPort::get_tx_queue_low_watermark);
+	ClassDB::bind_method(D_METHOD("set_tx_pacing_rate", "rate"), &SerialPort::set_tx_pacing_rate);
+	ClassDB::bind_method(D_METHOD("get_tx_pacing_rate"), &SerialPort::get_tx_pacing_rate);
+	ClassDB::bind_method(D_METHOD("set_tx_pacing_burst", "size"), &SerialPort::set_tx_pacing_burst);
+	ClassDB::bind_method(D_METHOD("get_tx_pacing_burst"), &SerialPort::get_tx_pacing_burst);
+	ClassDB::bind_method(D_METHOD("set_tx_pacing_gap", "usec"), &SerialPort::set_tx_pacing_gap);
+	ClassDB::bind_method(D_METHOD("get_tx_pacing_gap"), &SerialPort::get_tx_pacing_gap);
+	ClassDB::bind_method(D_METHOD("get_line_rate"), &SerialPort::get_line_rate);
+	ClassDB::bind_method(D_METHOD("transact", "id", "request", "timeout_ms", "retries"), &SerialPort::transact, DEFVAL(1000), DEFVAL(0));
+	ClassDB::bind_method(D_METHOD("cancel_transactions"), &SerialPort::cancel_transactions);
+	ClassDB::bind_method(D_METHOD("get_transactions_in_flight"), &SerialPort::get_transactions_in_flight);
+	ClassDB::bind_method(D_METHOD("get_transactions_waiting"), &SerialPort::get_transactions_waiting);
+	ClassDB::bind_method(D_METHOD("set_max_transactions_in_flight", "count"), &SerialPort::set_max_transactions_in_flight);
+	ClassDB::bind_method(D_METHOD("get_max_transactions_in_flight"), &SerialPort::get_max_transactions_in_flight);
+	ClassDB::bind_method(D_METHOD("set_transaction_id_offset", "offset"), &SerialPort::set_transaction_id_offset);
+	ClassDB::bind_method(D_METHOD("get_transaction_id_offset"), &SerialPort::get_transaction_id_offset);
+	ClassDB::bind_method(D_METHOD("set_transaction_id_size", "size"), &SerialPort::set_transaction_id_size);
+	ClassDB::bind_method(D_METHOD("get_transaction_id_size"), &SerialPort::get_transaction_id_size);
+	ClassDB::bind_method(D_METHOD("set_transaction_id_big_endian", "big_endian"), &SerialPort::set_transaction_id_big_endian);
+	ClassDB::bind_method(D_METHOD("is_transaction_id_big_endian"), &SerialPort::is_transaction_id_big_endian);
 	ClassDB::bind_method(D_METHOD("read_line", "max_len", "eol", "utf8_encoding"), &SerialPort::read_line, DEFVAL(65535), DEFVAL("\n"), DEFVAL(false));
 	ClassDB::bind_method(D_METHOD("read_lines", "max_len", "eol", "utf8_encoding"), &SerialPort::read_lines, DEFVAL(65535), DEFVAL("\n"), DEFVAL(false));
 
@@ -719,6 +2930,46 @@ void SerialPort::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "parity", PROPERTY_HINT_ENUM, "None, Odd, Even, Mark, Space"), "set_parity", "get_parity");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "stopbits", PROPERTY_HINT_ENUM, "1, 2, 1.5"), "set_stopbits", "get_stopbits");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "flowcontrol", PROPERTY_HINT_ENUM, "None, Software, Hardware"), "set_flowcontrol", "get_flowcontrol");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "monitoring_mode", PROPERTY_HINT_ENUM, "Polling, Event Driven, Shared"), "set_monitoring_mode", "get_monitoring_mode");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "rx_buffer_capacity"), "set_rx_buffer_capacity", "get_rx_buffer_capacity");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "manual_drain"), "set_manual_drain", "is_manual_drain");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "rx_timestamps"), "set_rx_timestamps", "is_rx_timestamps");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "max_processing_tasks"), "set_max_processing_tasks", "get_max_processing_tasks");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "tx_queue_capacity"), "set_tx_queue_capacity", "get_tx_queue_capacity");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "tx_queue_low_watermark"), "set_tx_queue_low_watermark", "get_tx_queue_low_watermark");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "tx_pacing_rate", PROPERTY_HINT_RANGE, "0,1,0.01"), "set_tx_pacing_rate", "get_tx_pacing_rate");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "tx_pacing_burst"), "set_tx_pacing_burst", "get_tx_pacing_burst");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "tx_pacing_gap"), "set_tx_pacing_gap", "get_tx_pacing_gap");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "max_transactions_in_flight"), "set_max_transactions_in_flight", "get_max_transactions_in_flight");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "transaction_id_offset"), "set_transaction_id_offset", "get_transaction_id_offset");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "transaction_id_size", PROPERTY_HINT_RANGE, "1,8"), "set_transaction_id_size", "get_transaction_id_size");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "transaction_id_big_endian"), "set_transaction_id_big_endian", "is_transaction_id_big_endian");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "batch_mode", PROPERTY_HINT_ENUM, "Disabled, Idle Frame"), "set_batch_mode", "get_batch_mode");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "batch_size_threshold"), "set_batch_size_threshold", "get_batch_size_threshold");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "batch_latency_threshold"), "set_batch_latency_threshold", "get_batch_latency_threshold");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "framing_mode", PROPERTY_HINT_ENUM, "None, Delimiter, Fixed Length, Length Prefix, SLIP, COBS, Lines"), "set_framing_mode", "get_framing_mode");
+	ADD_PROPERTY(PropertyInfo(Variant::PACKED_BYTE_ARRAY, "frame_delimiter"), "set_frame_delimiter", "get_frame_delimiter");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "frame_length"), "set_frame_length", "get_frame_length");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "length_field_offset"), "set_length_field_offset", "get_length_field_offset");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "length_field_size", PROPERTY_HINT_RANGE, "1,8"), "set_length_field_size", "get_length_field_size");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "length_field_big_endian"), "set_length_field_big_endian", "is_length_field_big_endian");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "length_adjustment"), "set_length_adjustment", "get_length_adjustment");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "max_frame_size"), "set_max_frame_size", "get_max_frame_size");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "checksum_type", PROPERTY_HINT_ENUM, "None, XOR8, SUM8, CRC16 Modbus, CRC16 CCITT, CRC32"), "set_checksum_type", "get_checksum_type");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "checksum_big_endian"), "set_checksum_big_endian", "is_checksum_big_endian");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "checksum_validate"), "set_checksum_validate", "is_checksum_validate");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "checksum_append"), "set_checksum_append", "is_checksum_append");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "capture_segment_size"), "set_capture_segment_size", "get_capture_segment_size");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "capture_max_segments"), "set_capture_max_segments", "get_capture_max_segments");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "replay_speed", PROPERTY_HINT_RANGE, "0,100,0.01,or_greater"), "set_replay_speed", "get_replay_speed");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "low_latency"), "set_low_latency", "is_low_latency");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "auto_reconnect"), "set_auto_reconnect", "is_auto_reconnect");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "reconnect_min_delay"), "set_reconnect_min_delay", "get_reconnect_min_delay");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "reconnect_max_delay"), "set_reconnect_max_delay", "get_reconnect_max_delay");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "error_retry_min_delay"), "set_error_retry_min_delay", "get_error_retry_min_delay");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "error_retry_max_delay"), "set_error_retry_max_delay", "get_error_retry_max_delay");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "error_failure_threshold"), "set_error_failure_threshold", "get_error_failure_threshold");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "error_signal_interval"), "set_error_signal_interval", "get_error_signal_interval");
 
 #ifndef GDEXTENSION
 	ADD_PROPERTY_DEFAULT("port", "");
@@ -728,12 +2979,66 @@ void SerialPort::_bind_methods() {
 	ADD_PROPERTY_DEFAULT("parity", PARITY_NONE);
 	ADD_PROPERTY_DEFAULT("stopbits", STOPBITS_1);
 	ADD_PROPERTY_DEFAULT("flowcontrol", FLOWCONTROL_NONE);
+	ADD_PROPERTY_DEFAULT("monitoring_mode", MONITORING_MODE_EVENT_DRIVEN);
+	ADD_PROPERTY_DEFAULT("rx_buffer_capacity", 65536);
+	ADD_PROPERTY_DEFAULT("manual_drain", false);
+	ADD_PROPERTY_DEFAULT("rx_timestamps", false);
+	ADD_PROPERTY_DEFAULT("max_processing_tasks", 0);
+	ADD_PROPERTY_DEFAULT("tx_queue_capacity", 1 << 20);
+	ADD_PROPERTY_DEFAULT("tx_queue_low_watermark", 1 << 16);
+	ADD_PROPERTY_DEFAULT("tx_pacing_rate", 0.0);
+	ADD_PROPERTY_DEFAULT("tx_pacing_burst", 16);
+	ADD_PROPERTY_DEFAULT("tx_pacing_gap", 0);
+	ADD_PROPERTY_DEFAULT("max_transactions_in_flight", 8);
+	ADD_PROPERTY_DEFAULT("transaction_id_offset", 0);
+	ADD_PROPERTY_DEFAULT("transaction_id_size", 1);
+	ADD_PROPERTY_DEFAULT("transaction_id_big_endian", false);
+	ADD_PROPERTY_DEFAULT("batch_mode", BATCH_MODE_DISABLED);
+	ADD_PROPERTY_DEFAULT("batch_size_threshold", 0);
+	ADD_PROPERTY_DEFAULT("batch_latency_threshold", 0);
+	ADD_PROPERTY_DEFAULT("framing_mode", FRAMING_NONE);
+	ADD_PROPERTY_DEFAULT("frame_length", 1);
+	ADD_PROPERTY_DEFAULT("length_field_offset", 0);
+	ADD_PROPERTY_DEFAULT("length_field_size", 1);
+	ADD_PROPERTY_DEFAULT("length_field_big_endian", false);
+	ADD_PROPERTY_DEFAULT("length_adjustment", 0);
+	ADD_PROPERTY_DEFAULT("max_frame_size", 4096);
+	ADD_PROPERTY_DEFAULT("checksum_type", CHECKSUM_NONE);
+	ADD_PROPERTY_DEFAULT("checksum_big_endian", false);
+	ADD_PROPERTY_DEFAULT("checksum_validate", true);
+	ADD_PROPERTY_DEFAULT("checksum_append", true);
+	ADD_PROPERTY_DEFAULT("capture_segment_size", 16 << 20);
+	ADD_PROPERTY_DEFAULT("capture_max_segments", 0);
+	ADD_PROPERTY_DEFAULT("replay_speed", 1.0);
+	ADD_PROPERTY_DEFAULT("low_latency", false);
+	ADD_PROPERTY_DEFAULT("auto_reconnect", false);
+	ADD_PROPERTY_DEFAULT("reconnect_min_delay", 100);
+	ADD_PROPERTY_DEFAULT("reconnect_max_delay", 5000);
+	ADD_PROPERTY_DEFAULT("error_retry_min_delay", 50);
+	ADD_PROPERTY_DEFAULT("error_retry_max_delay", 5000);
+	ADD_PROPERTY_DEFAULT("error_failure_threshold", 10);
+	ADD_PROPERTY_DEFAULT("error_signal_interval", 1000);
 #endif
 
 	ADD_SIGNAL(MethodInfo("got_error", PropertyInfo(Variant::STRING, "where"), PropertyInfo(Variant::STRING, "what")));
+	ADD_SIGNAL(MethodInfo("connection_state_changed", PropertyInfo(Variant::INT, "state")));
 	ADD_SIGNAL(MethodInfo("opened", PropertyInfo(Variant::STRING, "port")));
 	ADD_SIGNAL(MethodInfo("data_received", PropertyInfo(Variant::PACKED_BYTE_ARRAY, "data")));
+	ADD_SIGNAL(MethodInfo("packet_received", PropertyInfo(Variant::PACKED_BYTE_ARRAY, "packet")));
+	ADD_SIGNAL(MethodInfo("data_received_timestamped", PropertyInfo(Variant::PACKED_BYTE_ARRAY, "data"), PropertyInfo(Variant::INT, "usec")));
+	ADD_SIGNAL(MethodInfo("packet_received_timestamped", PropertyInfo(Variant::PACKED_BYTE_ARRAY, "packet"), PropertyInfo(Variant::INT, "usec")));
+	ADD_SIGNAL(MethodInfo("line_received", PropertyInfo(Variant::STRING, "line")));
+	ADD_SIGNAL(MethodInfo("checksum_failed", PropertyInfo(Variant::PACKED_BYTE_ARRAY, "packet")));
+	ADD_SIGNAL(MethodInfo("records_received", PropertyInfo(Variant::DICTIONARY, "records"), PropertyInfo(Variant::INT, "count")));
+	ADD_SIGNAL(MethodInfo("processed", PropertyInfo(Variant::NIL, "result", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_NIL_IS_VARIANT)));
 	ADD_SIGNAL(MethodInfo("closed", PropertyInfo(Variant::STRING, "port")));
+	ADD_SIGNAL(MethodInfo("write_completed", PropertyInfo(Variant::INT, "id")));
+	ADD_SIGNAL(MethodInfo("write_failed", PropertyInfo(Variant::INT, "id"), PropertyInfo(Variant::INT, "error")));
+	ADD_SIGNAL(MethodInfo("tx_queue_full"));
+	ADD_SIGNAL(MethodInfo("tx_queue_low"));
+	ADD_SIGNAL(MethodInfo("transaction_completed", PropertyInfo(Variant::INT, "id"), PropertyInfo(Variant::PACKED_BYTE_ARRAY, "response")));
+	ADD_SIGNAL(MethodInfo("transaction_failed", PropertyInfo(Variant::INT, "id"), PropertyInfo(Variant::INT, "error")));
+	ADD_SIGNAL(MethodInfo("replay_finished"));
 
 	BIND_ENUM_CONSTANT(BYTESIZE_5);
 	BIND_ENUM_CONSTANT(BYTESIZE_6);
@@ -753,4 +3058,41 @@ void SerialPort::_bind_methods() {
 	BIND_ENUM_CONSTANT(FLOWCONTROL_NONE);
 	BIND_ENUM_CONSTANT(FLOWCONTROL_SOFTWARE);
 	BIND_ENUM_CONSTANT(FLOWCONTROL_HARDWARE);
+
+	BIND_ENUM_CONSTANT(MONITORING_MODE_POLLING);
+	BIND_ENUM_CONSTANT(MONITORING_MODE_EVENT_DRIVEN);
+	BIND_ENUM_CONSTANT(MONITORING_MODE_SHARED);
+
+	BIND_ENUM_CONSTANT(BATCH_MODE_DISABLED);
+	BIND_ENUM_CONSTANT(BATCH_MODE_IDLE_FRAME);
+
+	BIND_ENUM_CONSTANT(FRAMING_NONE);
+	BIND_ENUM_CONSTANT(FRAMING_DELIMITER);
+	BIND_ENUM_CONSTANT(FRAMING_FIXED_LENGTH);
+	BIND_ENUM_CONSTANT(FRAMING_LENGTH_PREFIX);
+	BIND_ENUM_CONSTANT(FRAMING_SLIP);
+	BIND_ENUM_CONSTANT(FRAMING_COBS);
+	BIND_ENUM_CONSTANT(FRAMING_LINES);
+
+	BIND_ENUM_CONSTANT(CHECKSUM_NONE);
+	BIND_ENUM_CONSTANT(CHECKSUM_XOR8);
+	BIND_ENUM_CONSTANT(CHECKSUM_SUM8);
+	BIND_ENUM_CONSTANT(CHECKSUM_CRC16_MODBUS);
+	BIND_ENUM_CONSTANT(CHECKSUM_CRC16_CCITT);
+	BIND_ENUM_CONSTANT(CHECKSUM_CRC32);
+
+	BIND_ENUM_CONSTANT(RECORD_FIELD_INT8);
+	BIND_ENUM_CONSTANT(RECORD_FIELD_UINT8);
+	BIND_ENUM_CONSTANT(RECORD_FIELD_INT16);
+	BIND_ENUM_CONSTANT(RECORD_FIELD_UINT16);
+	BIND_ENUM_CONSTANT(RECORD_FIELD_INT32);
+	BIND_ENUM_CONSTANT(RECORD_FIELD_UINT32);
+	BIND_ENUM_CONSTANT(RECORD_FIELD_INT64);
+	BIND_ENUM_CONSTANT(RECORD_FIELD_UINT64);
+	BIND_ENUM_CONSTANT(RECORD_FIELD_FLOAT32);
+	BIND_ENUM_CONSTANT(RECORD_FIELD_FLOAT64);
+
+	BIND_ENUM_CONSTANT(CONNECTION_OK);
+	BIND_ENUM_CONSTANT(CONNECTION_DEGRADED);
+	BIND_ENUM_CONSTANT(CONNECTION_FAILED);
 }
@@ -32,38 +32,360 @@
 #define SERIAL_PORT_H
 
 #ifdef GDEXTENSION
+#include <godot_cpp/classes/stream_peer_buffer.hpp>
 #include <godot_cpp/templates/vector.hpp>
 #include <godot_cpp/variant/builtin_types.hpp>
 
 using namespace godot;
 #else
+#include "core/io/stream_peer.h"
 #include "core/string/ustring.h"
 #include "core/templates/vector.h"
 #include "core/variant/array.h"
 #include "core/variant/dictionary.h"
 #endif
 
+#include "serial_capture.h"
+#include "serial_checksum.h"
+#include "serial_framer.h"
+#include "serial_line_reader.h"
+#include "serial_link.h"
+#include "serial_low_latency.h"
+#include "serial_port_stats.h"
+#include "serial_read_request.h"
+#include "serial_record_decoder.h"
+#include "serial_replay.h"
+#include "serial_transaction_queue.h"
+#include "serial_tx_pacer.h"
+#include "spsc_ring_buffer.h"
+
 #include "serial/serial.h"
 
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
 #include <thread>
 
 using namespace serial;
 
+class ModbusRTUMaster;
+
 class SerialPort : public Object {
 	GDCLASS(SerialPort, Object);
 
-	static void _thread_func(void *p_user_data);
+public:
+	enum MonitoringMode {
+		MONITORING_MODE_POLLING,
+		MONITORING_MODE_EVENT_DRIVEN,
+		MONITORING_MODE_SHARED,
+	};
+	enum BatchMode {
+		BATCH_MODE_DISABLED,
+		BATCH_MODE_IDLE_FRAME,
+	};
+	enum FramingMode {
+		FRAMING_NONE = SerialFramer::MODE_NONE,
+		FRAMING_DELIMITER = SerialFramer::MODE_DELIMITER,
+		FRAMING_FIXED_LENGTH = SerialFramer::MODE_FIXED_LENGTH,
+		FRAMING_LENGTH_PREFIX = SerialFramer::MODE_LENGTH_PREFIX,
+		FRAMING_SLIP = SerialFramer::MODE_SLIP,
+		FRAMING_COBS = SerialFramer::MODE_COBS,
+		FRAMING_LINES,
+	};
+	enum ChecksumType {
+		CHECKSUM_NONE = SerialChecksum::TYPE_NONE,
+		CHECKSUM_XOR8 = SerialChecksum::TYPE_XOR8,
+		CHECKSUM_SUM8 = SerialChecksum::TYPE_SUM8,
+		CHECKSUM_CRC16_MODBUS = SerialChecksum::TYPE_CRC16_MODBUS,
+		CHECKSUM_CRC16_CCITT = SerialChecksum::TYPE_CRC16_CCITT,
+		CHECKSUM_CRC32 = SerialChecksum::TYPE_CRC32,
+	};
+	enum RecordFieldType {
+		RECORD_FIELD_INT8 = SerialRecordDecoder::FIELD_INT8,
+		RECORD_FIELD_UINT8 = SerialRecordDecoder::FIELD_UINT8,
+		RECORD_FIELD_INT16 = SerialRecordDecoder::FIELD_INT16,
+		RECORD_FIELD_UINT16 = SerialRecordDecoder::FIELD_UINT16,
+		RECORD_FIELD_INT32 = SerialRecordDecoder::FIELD_INT32,
+		RECORD_FIELD_UINT32 = SerialRecordDecoder::FIELD_UINT32,
+		RECORD_FIELD_INT64 = SerialRecordDecoder::FIELD_INT64,
+		RECORD_FIELD_UINT64 = SerialRecordDecoder::FIELD_UINT64,
+		RECORD_FIELD_FLOAT32 = SerialRecordDecoder::FIELD_FLOAT32,
+		RECORD_FIELD_FLOAT64 = SerialRecordDecoder::FIELD_FLOAT64,
+	};
+	enum ConnectionState {
+		CONNECTION_OK,
+		CONNECTION_DEGRADED,
+		CONNECTION_FAILED,
+	};
+
+private:
+	friend class SerialPortManager;
+	friend class ModbusRTUMaster;
 
+	// Monitor callbacks of `link`.
+	static bool _link_can_read(void *p_user_data);
+	static int64_t _link_get_retry_delay(void *p_user_data);
+	static int _link_open_fd(void *p_user_data);
+	static void _link_receive(void *p_user_data, uint64_t p_readable_at);
+	static void _link_on_error(void *p_user_data, const char *p_where, const char *p_what);
+
+#ifdef SERIAL_PORT_EVENT_MONITOR
+	void _wakeup_monitor();
+	int _open_rx_fd();
+#endif
+
+	// Concurrency model: `link` holds the lock every call into `serial` is
+	// made under, see SerialLink. It is only ever held around the call into
+	// `serial`, never while emitting signals, and got_error is deferred to
+	// the main thread, so handlers are free to close or reconfigure the port.
+	// Nothing blocks indefinitely under it, wait_for_change() polls the modem
+	// lines one sample at a time. Everything else shared with the monitor is
+	// atomic or has a lock of its own.
 	Serial *serial;
+	// Ahead of `link`, which counts monitor wakeups in it.
+	SerialPortStats stats;
+	SerialLink link;
+	// The device is open, rather than a capture played back.
+	std::atomic<bool> serial_open = false;
 	int monitoring_interval = 10000;
-	std::atomic<bool> fine_working = false;
+	MonitoringMode monitoring_mode = MONITORING_MODE_EVENT_DRIVEN;
 	std::atomic<bool> monitoring_should_exit = true;
-	std::thread thread;
+	bool monitoring_shared = false;
+	// Master talking over this port, stopped and detached when it's freed.
+	ModbusRTUMaster *modbus_master = nullptr;
+
+	// Received bytes travel from the monitor thread to the main thread through
+	// this ring, with at most one `_data_received` call queued at any time.
+	SPSCRingBuffer rx_buffer;
+	std::atomic<bool> rx_notify_pending = false;
+	std::atomic<bool> manual_drain = false;
+
+	// Pending `read_async()` and `read_until_async()` calls, served in
+	// order from `rx_buffer` ahead of `data_received`. Main thread only, but
+	// for the flag asking the monitor to notify even when draining manually.
+	std::deque<Ref<SerialReadRequest>> read_requests;
+	std::atomic<bool> read_requests_pending = false;
+	// Served requests whose `completed` is yet to be emitted.
+	std::vector<Ref<SerialReadRequest>> completed_read_requests;
+
+	// Steady clock time the oldest not yet emitted byte arrived at, 0 if none.
+	std::atomic<uint64_t> rx_batch_start = 0;
+	BatchMode batch_mode = BATCH_MODE_DISABLED;
+	int batch_size_threshold = 0;
+	int batch_latency_threshold = 0;
+	int last_batch_size = 0;
+	int last_batch_age = 0;
+
+	// Steady clock time each chunk's read() returned at, keyed by the stream
+	// offset past the chunk. Entries behind the read position are pruned by
+	// the monitor thread.
+	struct RxStamp {
+		size_t end;
+		uint64_t usec;
+	};
+	std::atomic<bool> rx_timestamps = false;
+	mutable std::mutex rx_stamp_mutex;
+	std::deque<RxStamp> rx_stamps;
+	// Time of the read the framer is being fed from, monitor thread only.
+	uint64_t rx_read_usec = 0;
+	// Added to steady clock times to match Time.get_ticks_usec().
+	int64_t ticks_offset = 0;
+
+	// With framing enabled the monitor thread splits the stream into packets
+	// itself and queues them instead of filling `rx_buffer`.
+	mutable std::mutex framer_mutex;
+	SerialFramer framer;
+	FramingMode framing_mode = FRAMING_NONE;
+	std::atomic<bool> framing_enabled = false;
+	std::vector<uint8_t> rx_scratch;
+	std::mutex packet_mutex;
+	std::deque<PackedByteArray> packets;
+	// Receive time of each queued packet, in engine ticks.
+	std::deque<int64_t> packet_times;
+	std::atomic<bool> packet_notify_pending = false;
+	std::atomic<uint64_t> dropped_packets = 0;
+
+	// Checksum trailing every packet, checked on the monitor thread. Packets
+	// failing it are reported through `checksum_failed` only.
+	std::atomic<ChecksumType> checksum_type = CHECKSUM_NONE;
+	std::atomic<bool> checksum_big_endian = false;
+	std::atomic<bool> checksum_validate = true;
+	bool checksum_append = true;
+	std::deque<PackedByteArray> bad_packets;
+	std::atomic<bool> bad_packet_notify_pending = false;
+	std::atomic<uint64_t> checksum_errors = 0;
+
+	// With a record schema, packets are decoded into columns on the monitor
+	// thread instead of being queued.
+	mutable std::mutex record_mutex;
+	SerialRecordDecoder record_decoder;
+	Vector<String> record_field_names;
+	std::atomic<bool> records_enabled = false;
+	std::atomic<bool> record_notify_pending = false;
+	std::atomic<uint64_t> dropped_records = 0;
+
+	// With a processor set, packets or raw batches are handed to it on the
+	// WorkerThreadPool instead of being emitted. Sequence numbers are given
+	// out on the main thread as tasks are added, and results are emitted in
+	// that order whichever task finishes first. Only `processing_results` is
+	// shared with the tasks.
+	struct ProcessingRequest {
+		PackedByteArray data;
+		Callable processor;
+	};
+	Callable packet_processor;
+	int max_processing_tasks = 0;
+	std::deque<ProcessingRequest> processing_queue;
+	std::map<uint64_t, int64_t> processing_tasks;
+	uint64_t processing_next_sequence = 0;
+	uint64_t processing_emit_sequence = 0;
+	std::mutex processing_mutex;
+	std::map<uint64_t, Variant> processing_results;
+	std::atomic<bool> processing_notify_pending = false;
+
+	// Writes queued by write_async(), drained in order by the writer thread.
+	struct TxRequest {
+		uint64_t id;
+		PackedByteArray data;
+		size_t offset = 0;
+		// The request of a transaction, whose timeout starts once it is written.
+		bool transaction = false;
+		int64_t transaction_id = 0;
+	};
+	std::thread tx_thread;
+	mutable std::mutex tx_mutex;
+	std::condition_variable tx_cond;
+	std::deque<TxRequest> tx_queue;
+	std::vector<uint64_t> tx_completed;
+	// Requests dropped unwritten, reported through `write_failed`.
+	std::vector<std::pair<uint64_t, Error>> tx_failed;
+	size_t tx_queued_bytes = 0;
+	bool tx_should_exit = false;
+	std::atomic<bool> tx_notify_pending = false;
+	uint64_t tx_last_id = 0;
+	bool tx_full = false;
+	int tx_queue_capacity = 1 << 20;
+	int tx_queue_low_watermark = 1 << 16;
+	// Throttles the writer thread for receivers without flow control.
+	SerialTxPacer tx_pacer;
+
+	// Requests sent by transact(), dispatched by the writer thread into
+	// `tx_queue` and matched to framed responses on the monitor thread, both
+	// under `tx_mutex`. `transactions_active` spares the monitor the lock
+	// while nothing is in flight.
+	SerialTransactionQueue transactions;
+	std::vector<SerialTransactionQueue::Completion> transaction_completions;
+	std::atomic<bool> transactions_active = false;
+	std::atomic<bool> transaction_notify_pending = false;
+
+	// Read-ahead of read_line()/read_lines(), the other reads consume it first.
+	SerialLineReader line_reader;
 
 	String error_message = "";
 
-	void _data_received(const PackedByteArray &buf);
+	// Category of the Performance monitors added by add_performance_monitors().
+	String performance_monitor_category;
+
+	// Every chunk read or written is appended while capturing.
+	SerialCapture capture;
+	int capture_segment_size = 16 << 20;
+	int capture_max_segments = 0;
+
+	// Ports named `replay://<path>` play a capture back instead of opening a device.
+	SerialReplay replay;
+	double replay_speed = 1.0;
+
+	// Applied on open while `low_latency` is set, reverted on close.
+	bool low_latency = false;
+	SerialLowLatency low_latency_settings;
+
+	// With `auto_reconnect`, a port whose device went away is closed and opened
+	// again once it is back. Settings live in `serial` and the monitor keeps
+	// running, so both survive the reconnection.
+	bool auto_reconnect = false;
+	int reconnect_min_delay = 100;
+	int reconnect_max_delay = 5000;
+	int reconnect_delay = 0;
+	bool reconnect_timer_pending = false;
+	std::atomic<bool> reconnecting = false;
+	std::atomic<bool> disconnect_pending = false;
+
+	// A failed read or write stops `link` receiving and leaves the port
+	// alone until `retry_at_usec`, doubling the delay with every error in a
+	// row, and for good after `error_failure_threshold` of them. Calls on the
+	// data path check it instead of letting the port throw again.
+	std::atomic<int> connection_state = CONNECTION_OK;
+	std::atomic<int> consecutive_errors = 0;
+	std::atomic<uint64_t> retry_at_usec = 0;
+	int error_retry_min_delay = 50;
+	int error_retry_max_delay = 5000;
+	int error_failure_threshold = 10;
+	ConnectionState emitted_connection_state = CONNECTION_OK;
+	std::atomic<bool> connection_state_notify_pending = false;
+
+	// got_error is emitted again for the same error only once
+	// `error_signal_interval` has passed, the rest are counted.
+	std::mutex error_mutex;
+	int error_signal_interval = 1000;
+	uint64_t error_signal_usec = 0;
+	String emitted_error;
+	std::atomic<uint64_t> suppressed_errors = 0;
+
+	static void _on_frame(void *p_user_data, const uint8_t *p_frame, size_t p_size);
+	static void _on_replay_finished(void *p_user_data);
+	static void _tx_thread_func(void *p_user_data);
+
+	bool _attempt_allowed(const char *where);
+	void _enter_backoff();
+	void _recover();
+	void _set_connection_state(ConnectionState state);
+	int64_t _retry_delay_usec() const;
+
+	size_t _available(const char *where);
+	size_t _read_bytes(uint8_t *buffer, size_t size, const char *where);
+	size_t _read_buffered(uint8_t *buffer, size_t size, const char *where);
+	size_t _buffer_line(size_t max_length, const CharString &eol, const char *where);
+	size_t _receive(size_t max_size = SIZE_MAX, uint64_t readable_at = 0);
+	size_t _receive_packets(size_t max_size, uint64_t readable_at);
+	void _packets_received();
+	void _on_bad_frame(const uint8_t *p_frame, size_t p_size);
+	void _bad_packets_received();
+	PackedByteArray _with_checksum(const PackedByteArray &data) const;
+	void _records_received();
+	void _queue_processing(const PackedByteArray &data);
+	void _dispatch_processing();
+	void _process_packet(const Callable &processor, int64_t sequence, const PackedByteArray &data);
+	void _processing_completed();
+	void _wait_processing();
+	Dictionary _take_records(int *r_count);
+	void _rx_consumed();
+	void _data_received();
+	Ref<SerialReadRequest> _queue_read_request(const PackedByteArray &delimiter, int size, int timeout_ms);
+	void _serve_read_requests();
+	// Position of `delimiter` in the buffered bytes from `from` to `limit`, or
+	// `limit`. Searches the receive buffer in place.
+	size_t _find_buffered(size_t from, size_t limit, const uint8_t *delimiter, size_t delimiter_size) const;
+	void _finish_read_request(const Ref<SerialReadRequest> &request, Error error, const PackedByteArray &result);
+	void _read_requests_completed();
+	void _read_request_timed_out(const Ref<SerialReadRequest> &request);
+	void _cancel_read_requests();
+	bool _is_batch_due() const;
+	void _flush_batch();
+
+	size_t _write_bytes(const uint8_t *data, size_t size, const char *where, Error *r_error = nullptr);
+	void _tx_loop();
+	void _stop_writer();
+	void _fail_tx_queue(Error error);
+	void _tx_progress();
+	double _get_byte_time_usec() const;
+	void _dispatch_transactions();
+	bool _match_transaction(const uint8_t *p_frame, size_t p_size);
+	void _notify_transactions();
+	void _transactions_completed();
+
+	int64_t _get_stat(const String &name) const;
 
 public:
 	enum ByteSize {
@@ -102,13 +424,168 @@ public:
 
 	static Dictionary list_ports();
 
-	bool is_in_error() { return is_open() && !fine_working; }
-	inline String get_last_error() { return error_message; }
+	bool is_in_error() { return is_open() && !link.is_receiving(); }
+	String get_last_error();
+	// Failed reads and writes back off from the port, other errors, like a
+	// setting it rejected, are only recorded and reported.
+	void _on_io_error(const String &where, const String &what);
 	void _on_error(const String &where, const String &what);
+	void _on_error_deferred(const String &where, const String &what);
 
 	Error start_monitoring(uint64_t interval_in_usec = 10000);
 	void stop_monitoring();
 
+	void set_monitoring_mode(MonitoringMode mode);
+	MonitoringMode get_monitoring_mode() const;
+
+	Error set_rx_buffer_capacity(int capacity);
+	int get_rx_buffer_capacity() const;
+
+	void set_manual_drain(bool enabled);
+	bool is_manual_drain() const;
+
+	void set_batch_mode(BatchMode mode);
+	BatchMode get_batch_mode() const;
+
+	void set_batch_size_threshold(int size);
+	int get_batch_size_threshold() const;
+
+	void set_batch_latency_threshold(int usec);
+	int get_batch_latency_threshold() const;
+
+	inline int get_last_batch_size() const { return last_batch_size; }
+	inline int get_last_batch_age() const { return last_batch_age; }
+
+	void set_rx_timestamps(bool enabled);
+	bool is_rx_timestamps() const;
+	int64_t get_buffered_timestamp() const;
+
+	void set_framing_mode(FramingMode mode);
+	FramingMode get_framing_mode() const;
+
+	void set_frame_delimiter(const PackedByteArray &delimiter);
+	PackedByteArray get_frame_delimiter() const;
+
+	void set_frame_length(int length);
+	int get_frame_length() const;
+
+	void set_length_field_offset(int offset);
+	int get_length_field_offset() const;
+
+	void set_length_field_size(int size);
+	int get_length_field_size() const;
+
+	void set_length_field_big_endian(bool big_endian);
+	bool is_length_field_big_endian() const;
+
+	void set_length_adjustment(int adjustment);
+	int get_length_adjustment() const;
+
+	void set_max_frame_size(int size);
+	int get_max_frame_size() const;
+
+	int get_available_packet_count();
+	PackedByteArray get_packet();
+	int64_t get_packet_timestamp();
+	int get_dropped_frames() const;
+
+	void set_checksum_type(ChecksumType type);
+	ChecksumType get_checksum_type() const;
+
+	void set_checksum_big_endian(bool big_endian);
+	bool is_checksum_big_endian() const;
+
+	void set_checksum_validate(bool enabled);
+	bool is_checksum_validate() const;
+
+	void set_checksum_append(bool enabled);
+	bool is_checksum_append() const;
+
+	int get_checksum_errors() const;
+	static int64_t compute_checksum(ChecksumType type, const PackedByteArray &data);
+
+	Error set_record_schema(const Array &fields, int record_size = 0);
+	Array get_record_schema() const;
+	int get_record_size() const;
+	int get_available_record_count() const;
+	Dictionary drain_records();
+	int get_dropped_records() const;
+
+	void set_packet_processor(const Callable &processor);
+	Callable get_packet_processor() const;
+
+	void set_max_processing_tasks(int count);
+	int get_max_processing_tasks() const;
+
+	int get_processing_tasks() const;
+	int get_queued_processing() const;
+
+	int get_buffered_bytes() const;
+	PackedByteArray peek_buffered(int max_size = -1) const;
+	PackedByteArray drain_buffered(int max_size = -1);
+	int drain_into(const Ref<StreamPeerBuffer> &buffer, int max_size = -1);
+	void clear_buffered();
+
+	Ref<SerialReadRequest> read_async(int size, int timeout_ms = 0);
+	Ref<SerialReadRequest> read_until_async(const PackedByteArray &delimiter, int max_size = 4096, int timeout_ms = 0);
+
+	Dictionary get_stats() const;
+	void reset_stats();
+
+	Error add_performance_monitors(const String &category = "");
+	void remove_performance_monitors();
+
+	Error start_capture(const String &path);
+	void stop_capture();
+	bool is_capturing() const;
+
+	void set_capture_segment_size(int size);
+	int get_capture_segment_size() const;
+
+	void set_capture_max_segments(int count);
+	int get_capture_max_segments() const;
+
+	void set_replay_speed(double speed);
+	double get_replay_speed() const;
+
+	void set_low_latency(bool enabled);
+	bool is_low_latency() const;
+	Dictionary get_low_latency_status() const;
+
+	void set_auto_reconnect(bool enabled);
+	bool is_auto_reconnect() const;
+
+	void set_reconnect_min_delay(int msec);
+	int get_reconnect_min_delay() const;
+
+	void set_reconnect_max_delay(int msec);
+	int get_reconnect_max_delay() const;
+
+	bool is_reconnecting() const;
+
+	ConnectionState get_connection_state() const;
+	void _connection_state_changed();
+
+	void set_error_retry_min_delay(int msec);
+	int get_error_retry_min_delay() const;
+
+	void set_error_retry_max_delay(int msec);
+	int get_error_retry_max_delay() const;
+
+	void set_error_failure_threshold(int count);
+	int get_error_failure_threshold() const;
+
+	void set_error_signal_interval(int msec);
+	int get_error_signal_interval() const;
+
+	int64_t get_suppressed_error_count() const;
+
+	void _on_disconnected();
+	void _on_reconnect_timer();
+	void _on_port_added(const String &port);
+	void _on_port_removed(const String &port);
+	void _replay_finished();
+
 	Error open(String port = "");
 
 	bool is_open() const;
@@ -123,12 +600,52 @@ public:
 
 	PackedByteArray read_raw(size_t size = 1);
 
+	int read_into(const Ref<StreamPeerBuffer> &buffer, int size = 1);
+
 	String read_str(size_t size = 1, bool utf8_encoding = false);
 
 	size_t write_raw(const PackedByteArray &data);
 
 	size_t write_str(const String &data, bool utf8_encoding = false);
 
+	int64_t write_async(const PackedByteArray &data);
+
+	int get_tx_queued_bytes();
+
+	void set_tx_queue_capacity(int capacity);
+	int get_tx_queue_capacity() const;
+
+	void set_tx_queue_low_watermark(int size);
+	int get_tx_queue_low_watermark() const;
+
+	void set_tx_pacing_rate(double rate);
+	double get_tx_pacing_rate() const;
+
+	void set_tx_pacing_burst(int size);
+	int get_tx_pacing_burst() const;
+
+	void set_tx_pacing_gap(int usec);
+	int get_tx_pacing_gap() const;
+
+	double get_line_rate() const;
+
+	Error transact(int64_t id, const PackedByteArray &request, int timeout_ms = 1000, int retries = 0);
+	void cancel_transactions();
+	int get_transactions_in_flight() const;
+	int get_transactions_waiting() const;
+
+	void set_max_transactions_in_flight(int count);
+	int get_max_transactions_in_flight() const;
+
+	void set_transaction_id_offset(int offset);
+	int get_transaction_id_offset() const;
+
+	void set_transaction_id_size(int size);
+	int get_transaction_id_size() const;
+
+	void set_transaction_id_big_endian(bool big_endian);
+	bool is_transaction_id_big_endian() const;
+
 	String read_line(size_t size = 65535, String eol = "\n", bool utf8_encoding = false);
 	PackedStringArray read_lines(size_t size = 65535, String eol = "\n", bool utf8_encoding = false);
 
@@ -194,5 +711,11 @@ VARIANT_ENUM_CAST(SerialPort::ByteSize);
 VARIANT_ENUM_CAST(SerialPort::Parity);
 VARIANT_ENUM_CAST(SerialPort::StopBits);
 VARIANT_ENUM_CAST(SerialPort::FlowControl);
+VARIANT_ENUM_CAST(SerialPort::MonitoringMode);
+VARIANT_ENUM_CAST(SerialPort::BatchMode);
+VARIANT_ENUM_CAST(SerialPort::FramingMode);
+VARIANT_ENUM_CAST(SerialPort::ChecksumType);
+VARIANT_ENUM_CAST(SerialPort::RecordFieldType);
+VARIANT_ENUM_CAST(SerialPort::ConnectionState);
 
 #endif // SERIAL_PORT_H
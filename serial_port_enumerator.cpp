@@ -0,0 +1,189 @@
+/*************************************************************************/
+/*  serial_port_enumerator.cpp                                           */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "serial_port_enumerator.h"
+
+#include "serial/serial.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef __linux__
+#include <climits>
+#include <cstring>
+#include <fstream>
+#endif
+
+static int _parse_hex(const std::string &p_string, size_t p_pos, size_t p_length) {
+	if (p_pos + p_length > p_string.size()) {
+		return -1;
+	}
+	int value = 0;
+	for (size_t i = p_pos; i < p_pos + p_length; i++) {
+		char c = p_string[i];
+		if (!isxdigit((unsigned char)c)) {
+			return -1;
+		}
+		value = value * 16 + (isdigit((unsigned char)c) ? c - '0' : tolower((unsigned char)c) - 'a' + 10);
+	}
+	return value;
+}
+
+static std::string _token(const std::string &p_string, size_t p_pos, const char *p_separators) {
+	size_t end = p_string.find_first_of(p_separators, p_pos);
+	return p_string.substr(p_pos, end == std::string::npos ? std::string::npos : end - p_pos);
+}
+
+void SerialPortEnumerator::parse_hardware_id(const std::string &p_hardware_id, SerialPortDetails &r_details) {
+	const std::string &id = p_hardware_id;
+	size_t pos;
+	if ((pos = id.find("VID:PID=")) != std::string::npos) {
+		r_details.vid = _parse_hex(id, pos + 8, 4);
+		r_details.pid = _parse_hex(id, pos + 13, 4);
+	}
+	if ((pos = id.find("SNR=")) != std::string::npos) {
+		r_details.serial_number = _token(id, pos + 4, " ");
+	}
+	if ((pos = id.find("VID_")) != std::string::npos) {
+		r_details.vid = _parse_hex(id, pos + 4, 4);
+	}
+	if ((pos = id.find("PID_")) != std::string::npos) {
+		r_details.pid = _parse_hex(id, pos + 4, 4);
+		// FTDIBUS ids carry the serial number after the product id.
+		if (pos + 8 < id.size() && id[pos + 8] == '+') {
+			r_details.serial_number = _token(id, pos + 9, "+\\");
+		}
+	}
+	if ((pos = id.find("MI_")) != std::string::npos) {
+		r_details.interface_number = _parse_hex(id, pos + 3, 2);
+	}
+}
+
+#ifdef __linux__
+static std::string _read_sysfs(const std::string &p_dir, const char *p_attribute) {
+	std::ifstream file(p_dir + "/" + p_attribute);
+	std::string value;
+	std::getline(file, value);
+	return value;
+}
+
+// Walks up from the tty's device to the USB interface and device, the same
+// attributes udev reads.
+static bool _describe_sysfs(const std::string &p_port, SerialPortDetails &r_details) {
+	char real_path[PATH_MAX];
+	std::string node = realpath(p_port.c_str(), real_path) ? real_path : p_port;
+	std::string name = node.substr(node.find_last_of('/') + 1);
+	if (!realpath(("/sys/class/tty/" + name + "/device").c_str(), real_path)) {
+		return false;
+	}
+	r_details.sysfs_path = real_path;
+
+	const size_t root_length = strlen("/sys/devices");
+	for (std::string dir = real_path; dir.size() > root_length; dir.resize(dir.find_last_of('/'))) {
+		if (r_details.interface_number < 0) {
+			std::string interface = _read_sysfs(dir, "bInterfaceNumber");
+			if (!interface.empty()) {
+				r_details.interface_number = _parse_hex(interface, 0, interface.size());
+			}
+		}
+		std::string vid = _read_sysfs(dir, "idVendor");
+		if (!vid.empty()) {
+			std::string pid = _read_sysfs(dir, "idProduct");
+			r_details.vid = _parse_hex(vid, 0, vid.size());
+			r_details.pid = _parse_hex(pid, 0, pid.size());
+			r_details.serial_number = _read_sysfs(dir, "serial");
+			r_details.manufacturer = _read_sysfs(dir, "manufacturer");
+			r_details.product = _read_sysfs(dir, "product");
+			break;
+		}
+	}
+	return true;
+}
+#endif
+
+std::vector<SerialPortDetails> SerialPortEnumerator::enumerate() {
+	std::vector<SerialPortDetails> ports;
+	for (const serial::PortInfo &info : serial::list_ports()) {
+		SerialPortDetails details;
+		details.port = info.port;
+		details.description = info.description;
+		details.hardware_id = info.hardware_id;
+		parse_hardware_id(info.hardware_id, details);
+#ifdef __linux__
+		_describe_sysfs(info.port, details);
+#endif
+		ports.push_back(details);
+	}
+	return ports;
+}
+
+bool SerialPortEnumerator::describe(const std::string &p_port, SerialPortDetails &r_details) {
+#ifdef __linux__
+	SerialPortDetails details;
+	details.port = p_port;
+	if (!_describe_sysfs(p_port, details)) {
+		return false;
+	}
+	// Same strings serial::list_ports() builds.
+	if (details.vid >= 0) {
+		char usb_id[32];
+		snprintf(usb_id, sizeof(usb_id), "USB VID:PID=%04x:%04x", details.vid, details.pid);
+		details.hardware_id = usb_id;
+		if (!details.serial_number.empty()) {
+			details.hardware_id += " SNR=" + details.serial_number;
+		}
+		details.description = details.manufacturer;
+		if (!details.product.empty()) {
+			details.description += (details.description.empty() ? "" : " ") + details.product;
+		}
+	}
+	if (details.description.empty()) {
+		details.description = p_port.substr(p_port.find_last_of('/') + 1);
+	}
+	if (details.hardware_id.empty()) {
+		details.hardware_id = "n/a";
+	}
+	r_details = details;
+	return true;
+#else
+	for (const serial::PortInfo &info : serial::list_ports()) {
+		if (info.port == p_port) {
+			r_details = SerialPortDetails();
+			r_details.port = info.port;
+			r_details.description = info.description;
+			r_details.hardware_id = info.hardware_id;
+			parse_hardware_id(info.hardware_id, r_details);
+			return true;
+		}
+	}
+	return false;
+#endif
+}
@@ -0,0 +1,66 @@
+/*************************************************************************/
+/*  serial_port_enumerator.h                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef SERIAL_PORT_ENUMERATOR_H
+#define SERIAL_PORT_ENUMERATOR_H
+
+#include <string>
+#include <vector>
+
+struct SerialPortDetails {
+	std::string port;
+	std::string description;
+	std::string hardware_id;
+	// -1 when unknown, like for on-board UARTs.
+	int vid = -1;
+	int pid = -1;
+	int interface_number = -1;
+	std::string serial_number;
+	std::string manufacturer;
+	std::string product;
+	// Linux only, the device the tty belongs to in /sys/devices.
+	std::string sysfs_path;
+};
+
+// Collects what the system knows about serial ports. Both calls walk
+// devices and can take a while, keep them off the main thread.
+class SerialPortEnumerator {
+public:
+	static std::vector<SerialPortDetails> enumerate();
+	// Describes a single port without listing the others where possible.
+	static bool describe(const std::string &p_port, SerialPortDetails &r_details);
+
+	// Fills the USB fields from a serial::PortInfo hardware id, as written
+	// on Linux and macOS ("USB VID:PID=0403:6001 SNR=A1B2C3") or Windows
+	// ("USB\VID_0403&PID_6001&MI_00", "FTDIBUS\VID_0403+PID_6001+A1B2C3A\0000").
+	static void parse_hardware_id(const std::string &p_hardware_id, SerialPortDetails &r_details);
+};
+
+#endif // SERIAL_PORT_ENUMERATOR_H
@@ -0,0 +1,72 @@
+/*************************************************************************/
+/*  serial_port_lock.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef SERIAL_PORT_LOCK_H
+#define SERIAL_PORT_LOCK_H
+
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+
+// Shared/exclusive lock for std::shared_lock and std::unique_lock. Reads and
+// writes hold it shared and overlap all the time, so a plain shared_mutex
+// may never let an exclusive locker in. Here a waiting exclusive locker holds
+// `gate`, which new shared lockers pass through first. The shared path costs
+// one atomic load while nobody waits.
+class SerialPortLock {
+	std::shared_mutex mutex;
+	std::mutex gate;
+	std::atomic<int> exclusive_waiting = 0;
+
+public:
+	void lock_shared() {
+		if (exclusive_waiting.load(std::memory_order_acquire) > 0) {
+			std::lock_guard<std::mutex> lock(gate);
+		}
+		mutex.lock_shared();
+	}
+
+	void unlock_shared() {
+		mutex.unlock_shared();
+	}
+
+	void lock() {
+		exclusive_waiting.fetch_add(1, std::memory_order_acq_rel);
+		std::lock_guard<std::mutex> lock(gate);
+		mutex.lock();
+		exclusive_waiting.fetch_sub(1, std::memory_order_acq_rel);
+	}
+
+	void unlock() {
+		mutex.unlock();
+	}
+};
+
+#endif // SERIAL_PORT_LOCK_H
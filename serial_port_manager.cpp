@@ -0,0 +1,644 @@
+/*************************************************************************/
+/*  serial_port_manager.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "serial_port_manager.h"
+
+#ifdef GDEXTENSION
+#include <godot_cpp/core/class_db.hpp>
+
+using namespace godot;
+#else
+#include "core/object/class_db.h"
+#endif
+
+#ifdef SERIAL_PORT_EVENT_MONITOR
+#include <chrono>
+#include <condition_variable>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+#endif
+
+SerialPortManager *SerialPortManager::singleton = nullptr;
+
+#ifdef SERIAL_PORT_EVENT_MONITOR
+struct SerialPortManager::Reactor {
+	struct Entry {
+		SerialPort *port;
+		int rx_fd = -1;
+		bool watching = false;
+	};
+
+	std::thread thread;
+	// Guards `entries`, `retired_fds` and `busy_port`. Ports are serviced
+	// with it released, so whatever they call may register, unregister or
+	// wake ports up.
+	std::mutex mutex;
+	std::vector<Entry> entries;
+	std::vector<int> retired_fds;
+	// Port being serviced, unregister_port() waits for it to be let go.
+	SerialPort *busy_port = nullptr;
+	std::condition_variable idle_cond;
+	std::atomic<bool> dirty = true;
+	std::atomic<bool> should_exit = false;
+	// Earliest end of a backoff delay among the degraded ports, if any.
+	bool retry_pending = false;
+	std::chrono::steady_clock::time_point retry_at;
+	int wakeup_fds[2] = { -1, -1 };
+#ifdef __linux__
+	int epoll_fd = -1;
+#else
+	// Only touched by the reactor thread: the wakeup pipe first, then one per watched port.
+	std::vector<struct pollfd> poll_fds;
+	std::vector<SerialPort *> poll_ports;
+#endif
+
+	Entry *find(SerialPort *port) {
+		for (Entry &entry : entries) {
+			if (entry.port == port) {
+				return &entry;
+			}
+		}
+		return nullptr;
+	}
+
+	void wakeup() {
+		dirty = true;
+		const uint8_t token = 0;
+		(void)!::write(wakeup_fds[1], &token, 1);
+	}
+
+	// Also cleans up after a reactor that failed to set up.
+	~Reactor() {
+		for (int fd : wakeup_fds) {
+			if (fd >= 0) {
+				::close(fd);
+			}
+		}
+#ifdef __linux__
+		if (epoll_fd >= 0) {
+			::close(epoll_fd);
+		}
+#endif
+	}
+};
+
+void SerialPortManager::_reactor_func(void *p_user_data) {
+	Reactor *reactor = static_cast<Reactor *>(p_user_data);
+	singleton->_reactor_loop(reactor);
+}
+
+void SerialPortManager::_sync_reactor(Reactor *reactor) {
+	for (int fd : reactor->retired_fds) {
+		::close(fd);
+	}
+	reactor->retired_fds.clear();
+	reactor->retry_pending = false;
+
+	for (Reactor::Entry &entry : reactor->entries) {
+		SerialPort *port = entry.port;
+		bool wants_fd = port->is_open() && port->_attempt_allowed(__FUNCTION__);
+		if (wants_fd && entry.rx_fd < 0) {
+			entry.rx_fd = port->_open_rx_fd();
+		} else if (!wants_fd && entry.rx_fd >= 0) {
+			::close(entry.rx_fd);
+			entry.rx_fd = -1;
+			entry.watching = false;
+		}
+		int64_t retry_delay = port->_retry_delay_usec();
+		if (entry.rx_fd < 0 && retry_delay >= 0) {
+			std::chrono::steady_clock::time_point retry_at = std::chrono::steady_clock::now() + std::chrono::microseconds(retry_delay);
+			if (!reactor->retry_pending || retry_at < reactor->retry_at) {
+				reactor->retry_at = retry_at;
+			}
+			reactor->retry_pending = true;
+		}
+
+		// A port with a full receive buffer is left alone until it is drained.
+		bool watch = entry.rx_fd >= 0 && !port->link.is_receive_blocked();
+#ifdef __linux__
+		if (watch != entry.watching) {
+			struct epoll_event event = {};
+			event.events = EPOLLIN;
+			event.data.ptr = port;
+			epoll_ctl(reactor->epoll_fd, watch ? EPOLL_CTL_ADD : EPOLL_CTL_DEL, entry.rx_fd, &event);
+		}
+#endif
+		entry.watching = watch;
+	}
+
+#ifndef __linux__
+	reactor->poll_fds.resize(1);
+	reactor->poll_ports.clear();
+	for (const Reactor::Entry &entry : reactor->entries) {
+		if (entry.watching) {
+			reactor->poll_fds.push_back({ entry.rx_fd, POLLIN, 0 });
+			reactor->poll_ports.push_back(entry.port);
+		}
+	}
+#endif
+}
+
+void SerialPortManager::_reactor_loop(Reactor *reactor) {
+	struct Ready {
+		SerialPort *port;
+		bool hangup;
+	};
+	std::vector<Ready> ready;
+#ifndef __linux__
+	reactor->poll_fds.push_back({ reactor->wakeup_fds[0], POLLIN, 0 });
+#endif
+
+	while (!reactor->should_exit) {
+		if (reactor->dirty.exchange(false)) {
+			std::lock_guard<std::mutex> lock(reactor->mutex);
+			_sync_reactor(reactor);
+		}
+
+		ready.clear();
+		bool woken = false;
+		int timeout = -1;
+		if (reactor->retry_pending) {
+			int64_t delay = std::chrono::duration_cast<std::chrono::microseconds>(reactor->retry_at - std::chrono::steady_clock::now()).count();
+			timeout = delay > 0 ? int((delay + 999) / 1000) : 0;
+		}
+#ifdef __linux__
+		struct epoll_event events[64];
+		int count = epoll_wait(reactor->epoll_fd, events, 64, timeout);
+		for (int i = 0; i < count; i++) {
+			if (events[i].data.ptr) {
+				ready.push_back({ static_cast<SerialPort *>(events[i].data.ptr), (events[i].events & (EPOLLERR | EPOLLHUP)) != 0 });
+			} else {
+				woken = true;
+			}
+		}
+#else
+		int count = ::poll(reactor->poll_fds.data(), reactor->poll_fds.size(), timeout);
+		for (size_t i = 1; count > 0 && i < reactor->poll_fds.size(); i++) {
+			short revents = reactor->poll_fds[i].revents;
+			if (revents) {
+				ready.push_back({ reactor->poll_ports[i - 1], (revents & (POLLERR | POLLHUP | POLLNVAL)) != 0 });
+			}
+		}
+		woken = count > 0 && (reactor->poll_fds[0].revents & POLLIN);
+#endif
+		if (count < 0 && errno != EINTR) {
+			// Tell the ports, which would otherwise go quiet, and try again
+			// after a while rather than leave them unmonitored.
+			String what = strerror(errno);
+			{
+				std::lock_guard<std::mutex> lock(reactor->mutex);
+				for (const Reactor::Entry &entry : reactor->entries) {
+					entry.port->_on_error(__FUNCTION__, what);
+				}
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			reactor->dirty = true;
+			continue;
+		}
+		if (woken) {
+			uint8_t tokens[64];
+			while (::read(reactor->wakeup_fds[0], tokens, sizeof(tokens)) > 0) {
+			}
+		}
+		if (reactor->retry_pending && std::chrono::steady_clock::now() >= reactor->retry_at) {
+			reactor->dirty = true;
+		}
+
+		// Level triggered: a port with more data than the budget is simply
+		// reported again on the next round, after every other ready port.
+		size_t budget = max_bytes_per_wakeup;
+		for (const Ready &event : ready) {
+			SerialPort *port = event.port;
+			{
+				std::lock_guard<std::mutex> lock(reactor->mutex);
+				Reactor::Entry *entry = reactor->find(port);
+				if (!entry || !entry->watching) {
+					continue;
+				}
+				if (event.hangup) {
+					reactor->retired_fds.push_back(entry->rx_fd);
+					entry->rx_fd = -1;
+					entry->watching = false;
+					reactor->dirty = true;
+				}
+				reactor->busy_port = port;
+			}
+
+			if (event.hangup) {
+				port->_on_io_error(__FUNCTION__, "Port hung up.");
+			} else {
+				SerialPortStats::add(port->stats.monitor_wakeups);
+				if (port->link.is_receiving() && port->is_open()) {
+					port->_receive(budget);
+				}
+				// Backing off after an error, give the descriptor up until the retry.
+				if (port->link.is_receive_blocked() || !port->link.is_receiving()) {
+					reactor->dirty = true;
+				}
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(reactor->mutex);
+				reactor->busy_port = nullptr;
+			}
+			reactor->idle_cond.notify_all();
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(reactor->mutex);
+	for (const Reactor::Entry &entry : reactor->entries) {
+		if (entry.rx_fd >= 0) {
+			::close(entry.rx_fd);
+		}
+	}
+	for (int fd : reactor->retired_fds) {
+		::close(fd);
+	}
+	reactor->entries.clear();
+	reactor->retired_fds.clear();
+}
+
+void SerialPortManager::_stop_reactors() {
+	for (Reactor *reactor : reactors) {
+		reactor->should_exit = true;
+		reactor->wakeup();
+		if (reactor->thread.joinable()) {
+			reactor->thread.join();
+		}
+		delete reactor;
+	}
+	reactors.clear();
+}
+#endif
+
+SerialPortManager *SerialPortManager::get_singleton() {
+	return singleton;
+}
+
+Error SerialPortManager::register_port(SerialPort *port) {
+#ifdef SERIAL_PORT_EVENT_MONITOR
+	std::lock_guard<std::mutex> lock(mutex);
+	if (reactors.empty()) {
+		for (int i = 0; i < thread_count; i++) {
+			Reactor *reactor = new Reactor;
+			bool failed = pipe(reactor->wakeup_fds) != 0;
+#ifdef __linux__
+			if (!failed) {
+				reactor->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+				struct epoll_event event = {};
+				event.events = EPOLLIN;
+				event.data.ptr = nullptr;
+				failed = reactor->epoll_fd < 0 || epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, reactor->wakeup_fds[0], &event) != 0;
+			}
+#endif
+			if (failed) {
+				delete reactor;
+				_stop_reactors();
+				ERR_FAIL_V_MSG(ERR_CANT_CREATE, "Failed to create serial port reactor.");
+			}
+			fcntl(reactor->wakeup_fds[0], F_SETFL, fcntl(reactor->wakeup_fds[0], F_GETFL) | O_NONBLOCK);
+			fcntl(reactor->wakeup_fds[1], F_SETFL, fcntl(reactor->wakeup_fds[1], F_GETFL) | O_NONBLOCK);
+			reactors.push_back(reactor);
+			reactor->thread = std::thread(_reactor_func, reactor);
+		}
+	}
+
+	// New ports go to the least loaded reactor.
+	Reactor *target = nullptr;
+	size_t target_size = SIZE_MAX;
+	for (Reactor *reactor : reactors) {
+		std::lock_guard<std::mutex> reactor_lock(reactor->mutex);
+		if (reactor->entries.size() < target_size) {
+			target = reactor;
+			target_size = reactor->entries.size();
+		}
+	}
+	{
+		std::lock_guard<std::mutex> reactor_lock(target->mutex);
+		target->entries.push_back({ port });
+	}
+	target->wakeup();
+	return OK;
+#else
+	return ERR_UNAVAILABLE;
+#endif
+}
+
+void SerialPortManager::unregister_port(SerialPort *port) {
+#ifdef SERIAL_PORT_EVENT_MONITOR
+	Reactor *owner = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (Reactor *reactor : reactors) {
+			std::lock_guard<std::mutex> reactor_lock(reactor->mutex);
+			Reactor::Entry *entry = reactor->find(port);
+			if (!entry) {
+				continue;
+			}
+			// The reactor may be polling the descriptor right now, let it close it.
+			if (entry->rx_fd >= 0) {
+				reactor->retired_fds.push_back(entry->rx_fd);
+			}
+			reactor->entries.erase(reactor->entries.begin() + (entry - reactor->entries.data()));
+			reactor->wakeup();
+			owner = reactor;
+			break;
+		}
+	}
+	// Reactors are only stopped with no port registered, so `owner` stays
+	// valid. Waiting without the manager lock lets the port being serviced
+	// call wakeup() meanwhile. The reactor thread itself is never waited for.
+	if (owner && std::this_thread::get_id() != owner->thread.get_id()) {
+		std::unique_lock<std::mutex> reactor_lock(owner->mutex);
+		owner->idle_cond.wait(reactor_lock, [owner, port] { return owner->busy_port != port; });
+	}
+#endif
+}
+
+void SerialPortManager::wakeup(SerialPort *port) {
+#ifdef SERIAL_PORT_EVENT_MONITOR
+	std::lock_guard<std::mutex> lock(mutex);
+	for (Reactor *reactor : reactors) {
+		std::lock_guard<std::mutex> reactor_lock(reactor->mutex);
+		if (reactor->find(port)) {
+			reactor->wakeup();
+			return;
+		}
+	}
+#endif
+}
+
+Error SerialPortManager::set_thread_count(int count) {
+	ERR_FAIL_COND_V(count < 1, ERR_INVALID_PARAMETER);
+	// Checked under the same lock the reactors are stopped under, so no port
+	// registers in between.
+	std::lock_guard<std::mutex> lock(mutex);
+	ERR_FAIL_COND_V_MSG(_count_ports() > 0, ERR_BUSY, "Can't change the thread count while ports are registered.");
+#ifdef SERIAL_PORT_EVENT_MONITOR
+	// Idle reactors are restarted with the new count by the next register_port().
+	_stop_reactors();
+#endif
+	thread_count = count;
+	return OK;
+}
+
+int SerialPortManager::get_thread_count() const {
+	return thread_count;
+}
+
+void SerialPortManager::set_max_bytes_per_wakeup(int size) {
+	ERR_FAIL_COND(size <= 0);
+	max_bytes_per_wakeup = size;
+}
+
+int SerialPortManager::get_max_bytes_per_wakeup() const {
+	return max_bytes_per_wakeup;
+}
+
+int SerialPortManager::_count_ports() {
+	int count = 0;
+	for (Reactor *reactor : reactors) {
+		std::lock_guard<std::mutex> reactor_lock(reactor->mutex);
+		count += reactor->entries.size();
+	}
+	return count;
+}
+
+int SerialPortManager::get_port_count() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return _count_ports();
+}
+
+void SerialPortManager::_on_port_event(void *p_user_data, bool p_added, const std::string &p_port) {
+	SerialPortManager *manager = static_cast<SerialPortManager *>(p_user_data);
+	// Describing a port reads sysfs, keep it on the watcher thread.
+	SerialPortDetails details;
+	if (!p_added) {
+		manager->_remove_port_details(p_port);
+	} else if (SerialPortEnumerator::describe(p_port, details)) {
+		manager->_add_port_details(details);
+	}
+	{
+		std::lock_guard<std::mutex> lock(manager->port_event_mutex);
+		manager->port_events.push_back({ p_added, String(p_port.c_str()) });
+	}
+	if (!manager->port_event_notify_pending.exchange(true)) {
+		manager->call_deferred("_port_events_received");
+	}
+}
+
+void SerialPortManager::_port_events_received() {
+	port_event_notify_pending = false;
+	std::vector<std::pair<bool, String>> events;
+	{
+		std::lock_guard<std::mutex> lock(port_event_mutex);
+		events.swap(port_events);
+	}
+	for (const std::pair<bool, String> &event : events) {
+		emit_signal(event.first ? "port_added" : "port_removed", event.second);
+	}
+}
+
+void SerialPortManager::start_watching_ports() {
+	if (port_watch_count++ == 0) {
+		port_watcher.start(_on_port_event, this);
+	}
+}
+
+void SerialPortManager::stop_watching_ports() {
+	ERR_FAIL_COND_MSG(port_watch_count == 0, "Ports are not watched.");
+	if (--port_watch_count == 0) {
+		port_watcher.stop();
+	}
+}
+
+bool SerialPortManager::is_watching_ports() const {
+	return port_watch_count > 0;
+}
+
+void SerialPortManager::_add_port_details(const SerialPortDetails &p_details) {
+	std::lock_guard<std::mutex> lock(port_table_mutex);
+	port_table[p_details.port] = p_details;
+	if (p_details.serial_number.empty()) {
+		return;
+	}
+	// Multi-channel adapters share one serial number, the first interface wins.
+	auto it = ports_by_serial_number.find(p_details.serial_number);
+	if (it == ports_by_serial_number.end() || port_table[it->second].interface_number > p_details.interface_number) {
+		ports_by_serial_number[p_details.serial_number] = p_details.port;
+	}
+}
+
+void SerialPortManager::_remove_port_details(const std::string &p_port) {
+	std::lock_guard<std::mutex> lock(port_table_mutex);
+	auto it = port_table.find(p_port);
+	if (it == port_table.end()) {
+		return;
+	}
+	std::string serial_number = it->second.serial_number;
+	port_table.erase(it);
+	auto serial_it = ports_by_serial_number.find(serial_number);
+	if (serial_it == ports_by_serial_number.end() || serial_it->second != p_port) {
+		return;
+	}
+	ports_by_serial_number.erase(serial_it);
+	const SerialPortDetails *next = nullptr;
+	for (const std::pair<const std::string, SerialPortDetails> &entry : port_table) {
+		if (entry.second.serial_number == serial_number && (!next || entry.second.interface_number < next->interface_number)) {
+			next = &entry.second;
+		}
+	}
+	if (next) {
+		ports_by_serial_number[serial_number] = next->port;
+	}
+}
+
+void SerialPortManager::_enumerate_func() {
+	std::vector<SerialPortDetails> ports = SerialPortEnumerator::enumerate();
+	{
+		std::lock_guard<std::mutex> lock(port_table_mutex);
+		port_table.clear();
+		ports_by_serial_number.clear();
+	}
+	for (const SerialPortDetails &details : ports) {
+		_add_port_details(details);
+	}
+	call_deferred("_enumeration_finished");
+}
+
+void SerialPortManager::_enumeration_finished() {
+	if (enumeration_thread.joinable()) {
+		enumeration_thread.join();
+	}
+	enumerating = false;
+	emit_signal("enumeration_completed");
+}
+
+Dictionary SerialPortManager::_details_to_dict(const SerialPortDetails &p_details) {
+	Dictionary info;
+	info["desc"] = p_details.description.c_str();
+	info["hw_id"] = p_details.hardware_id.c_str();
+	info["vid"] = p_details.vid;
+	info["pid"] = p_details.pid;
+	info["serial_number"] = String::utf8(p_details.serial_number.c_str());
+	info["manufacturer"] = String::utf8(p_details.manufacturer.c_str());
+	info["product"] = String::utf8(p_details.product.c_str());
+	info["interface_number"] = p_details.interface_number;
+	info["sysfs_path"] = p_details.sysfs_path.c_str();
+	return info;
+}
+
+Error SerialPortManager::enumerate_ports() {
+	if (enumerating.exchange(true)) {
+		return ERR_BUSY;
+	}
+	if (enumeration_thread.joinable()) {
+		enumeration_thread.join();
+	}
+	enumeration_thread = std::thread(&SerialPortManager::_enumerate_func, this);
+	return OK;
+}
+
+bool SerialPortManager::is_enumerating() const {
+	return enumerating;
+}
+
+Dictionary SerialPortManager::get_ports() {
+	std::lock_guard<std::mutex> lock(port_table_mutex);
+	Dictionary ports;
+	for (const std::pair<const std::string, SerialPortDetails> &entry : port_table) {
+		ports[entry.first.c_str()] = _details_to_dict(entry.second);
+	}
+	return ports;
+}
+
+Dictionary SerialPortManager::get_port_info(const String &p_port) {
+	std::lock_guard<std::mutex> lock(port_table_mutex);
+	auto it = port_table.find(p_port.utf8().get_data());
+	if (it == port_table.end()) {
+		return Dictionary();
+	}
+	return _details_to_dict(it->second);
+}
+
+String SerialPortManager::find_port_by_serial_number(const String &p_serial_number) {
+	std::lock_guard<std::mutex> lock(port_table_mutex);
+	auto it = ports_by_serial_number.find(p_serial_number.utf8().get_data());
+	if (it == ports_by_serial_number.end()) {
+		return String();
+	}
+	return it->second.c_str();
+}
+
+SerialPortManager::SerialPortManager() {
+	singleton = this;
+}
+
+SerialPortManager::~SerialPortManager() {
+	port_watcher.stop();
+	if (enumeration_thread.joinable()) {
+		enumeration_thread.join();
+	}
+#ifdef SERIAL_PORT_EVENT_MONITOR
+	_stop_reactors();
+#endif
+	singleton = nullptr;
+}
+
+void SerialPortManager::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_thread_count", "count"), &SerialPortManager::set_thread_count);
+	ClassDB::bind_method(D_METHOD("get_thread_count"), &SerialPortManager::get_thread_count);
+	ClassDB::bind_method(D_METHOD("set_max_bytes_per_wakeup", "size"), &SerialPortManager::set_max_bytes_per_wakeup);
+	ClassDB::bind_method(D_METHOD("get_max_bytes_per_wakeup"), &SerialPortManager::get_max_bytes_per_wakeup);
+	ClassDB::bind_method(D_METHOD("get_port_count"), &SerialPortManager::get_port_count);
+	ClassDB::bind_method(D_METHOD("start_watching_ports"), &SerialPortManager::start_watching_ports);
+	ClassDB::bind_method(D_METHOD("stop_watching_ports"), &SerialPortManager::stop_watching_ports);
+	ClassDB::bind_method(D_METHOD("is_watching_ports"), &SerialPortManager::is_watching_ports);
+	ClassDB::bind_method(D_METHOD("_port_events_received"), &SerialPortManager::_port_events_received);
+	ClassDB::bind_method(D_METHOD("enumerate_ports"), &SerialPortManager::enumerate_ports);
+	ClassDB::bind_method(D_METHOD("is_enumerating"), &SerialPortManager::is_enumerating);
+	ClassDB::bind_method(D_METHOD("get_ports"), &SerialPortManager::get_ports);
+	ClassDB::bind_method(D_METHOD("get_port_info", "port"), &SerialPortManager::get_port_info);
+	ClassDB::bind_method(D_METHOD("find_port_by_serial_number", "serial_number"), &SerialPortManager::find_port_by_serial_number);
+	ClassDB::bind_method(D_METHOD("_enumeration_finished"), &SerialPortManager::_enumeration_finished);
+
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "thread_count"), "set_thread_count", "get_thread_count");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "max_bytes_per_wakeup"), "set_max_bytes_per_wakeup", "get_max_bytes_per_wakeup");
+
+	ADD_SIGNAL(MethodInfo("port_added", PropertyInfo(Variant::STRING, "port")));
+	ADD_SIGNAL(MethodInfo("port_removed", PropertyInfo(Variant::STRING, "port")));
+	ADD_SIGNAL(MethodInfo("enumeration_completed"));
+}
@@ -0,0 +1,124 @@
+/*************************************************************************/
+/*  serial_port_manager.h                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef SERIAL_PORT_MANAGER_H
+#define SERIAL_PORT_MANAGER_H
+
+#include "serial_port.h"
+#include "serial_port_enumerator.h"
+#include "serial_port_watcher.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Monitors any number of ports from a small fixed pool of reactor threads,
+// for ports started with MONITORING_MODE_SHARED, reports ports being
+// plugged in and out and keeps a table of the ports present.
+class SerialPortManager : public Object {
+	GDCLASS(SerialPortManager, Object);
+
+	static SerialPortManager *singleton;
+
+	struct Reactor;
+
+#ifdef SERIAL_PORT_EVENT_MONITOR
+	static void _reactor_func(void *p_user_data);
+	void _reactor_loop(Reactor *reactor);
+	void _sync_reactor(Reactor *reactor);
+	void _stop_reactors();
+#endif
+
+	std::mutex mutex;
+	std::vector<Reactor *> reactors;
+	int thread_count = 1;
+	std::atomic<int> max_bytes_per_wakeup = 16384;
+
+	// With `mutex` held.
+	int _count_ports();
+
+	// Runs while any start_watching_ports() is not matched by a stop.
+	SerialPortWatcher port_watcher;
+	int port_watch_count = 0;
+	std::mutex port_event_mutex;
+	std::vector<std::pair<bool, String>> port_events;
+	std::atomic<bool> port_event_notify_pending = false;
+
+	static void _on_port_event(void *p_user_data, bool p_added, const std::string &p_port);
+	void _port_events_received();
+
+	// Filled by enumerate_ports(), then kept up to date by port events.
+	std::mutex port_table_mutex;
+	std::unordered_map<std::string, SerialPortDetails> port_table;
+	std::unordered_map<std::string, std::string> ports_by_serial_number;
+	std::thread enumeration_thread;
+	std::atomic<bool> enumerating = false;
+
+	void _add_port_details(const SerialPortDetails &p_details);
+	void _remove_port_details(const std::string &p_port);
+	void _enumerate_func();
+	void _enumeration_finished();
+	static Dictionary _details_to_dict(const SerialPortDetails &p_details);
+
+public:
+	static SerialPortManager *get_singleton();
+
+	Error register_port(SerialPort *port);
+	void unregister_port(SerialPort *port);
+	void wakeup(SerialPort *port);
+
+	Error set_thread_count(int count);
+	int get_thread_count() const;
+
+	void set_max_bytes_per_wakeup(int size);
+	int get_max_bytes_per_wakeup() const;
+
+	int get_port_count();
+
+	void start_watching_ports();
+	void stop_watching_ports();
+	bool is_watching_ports() const;
+
+	Error enumerate_ports();
+	bool is_enumerating() const;
+	Dictionary get_ports();
+	Dictionary get_port_info(const String &p_port);
+	String find_port_by_serial_number(const String &p_serial_number);
+
+	SerialPortManager();
+	~SerialPortManager();
+
+protected:
+	static void _bind_methods();
+};
+
+#endif // SERIAL_PORT_MANAGER_H
@@ -0,0 +1,149 @@
+/*************************************************************************/
+/*  serial_port_stats.h                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef SERIAL_PORT_STATS_H
+#define SERIAL_PORT_STATS_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+// Counters updated from the monitor, writer and main threads. Everything on
+// the data path is a relaxed atomic increment, only errors take a lock.
+struct SerialPortStats {
+	// Bucket i counts latencies below 2^i microseconds, the last one the rest.
+	static const int LATENCY_BUCKETS = 26;
+
+	std::atomic<uint64_t> rx_bytes = 0;
+	std::atomic<uint64_t> rx_chunks = 0;
+	std::atomic<uint64_t> read_calls = 0;
+	std::atomic<uint64_t> tx_bytes = 0;
+	std::atomic<uint64_t> tx_chunks = 0;
+	std::atomic<uint64_t> write_calls = 0;
+	std::atomic<uint64_t> monitor_wakeups = 0;
+	std::atomic<uint64_t> empty_polls = 0;
+	std::atomic<uint64_t> errors = 0;
+
+	std::atomic<uint64_t> rx_buffer_high_water = 0;
+	std::atomic<uint64_t> packet_queue_high_water = 0;
+	std::atomic<uint64_t> tx_queue_high_water = 0;
+
+	std::atomic<uint64_t> transactions_completed = 0;
+	std::atomic<uint64_t> transactions_failed = 0;
+	std::atomic<uint64_t> transaction_retries = 0;
+	// Current value rather than a counter, left alone by reset().
+	std::atomic<uint64_t> transactions_in_flight = 0;
+	std::atomic<uint64_t> transactions_in_flight_high_water = 0;
+
+	mutable std::mutex errors_mutex;
+	std::map<std::string, uint64_t> errors_by_where;
+
+	static void update_max(std::atomic<uint64_t> &value, uint64_t sample) {
+		uint64_t current = value.load(std::memory_order_relaxed);
+		while (sample > current && !value.compare_exchange_weak(current, sample, std::memory_order_relaxed)) {
+		}
+	}
+
+	static void add(std::atomic<uint64_t> &value, uint64_t amount = 1) {
+		value.fetch_add(amount, std::memory_order_relaxed);
+	}
+
+	struct Latency {
+		std::atomic<uint64_t> buckets[LATENCY_BUCKETS] = {};
+		std::atomic<uint64_t> count = 0;
+		std::atomic<uint64_t> total = 0;
+		std::atomic<uint64_t> max = 0;
+
+		void record(uint64_t usec) {
+			int bucket = 0;
+			while (bucket < LATENCY_BUCKETS - 1 && usec >= (uint64_t(1) << bucket)) {
+				bucket++;
+			}
+			add(buckets[bucket]);
+			add(count);
+			add(total, usec);
+			update_max(max, usec);
+		}
+
+		// Upper bound of the bucket holding the given fraction of the samples.
+		uint64_t percentile(double fraction) const {
+			uint64_t samples = count.load(std::memory_order_relaxed);
+			if (samples == 0) {
+				return 0;
+			}
+			uint64_t target = uint64_t(samples * fraction);
+			uint64_t seen = 0;
+			for (int i = 0; i < LATENCY_BUCKETS - 1; i++) {
+				seen += buckets[i].load(std::memory_order_relaxed);
+				if (seen > target) {
+					return uint64_t(1) << i;
+				}
+			}
+			return max.load(std::memory_order_relaxed);
+		}
+
+		void reset() {
+			for (std::atomic<uint64_t> *value : { &count, &total, &max }) {
+				value->store(0, std::memory_order_relaxed);
+			}
+			for (std::atomic<uint64_t> &bucket : buckets) {
+				bucket.store(0, std::memory_order_relaxed);
+			}
+		}
+	};
+
+	// Port becoming readable to the data being emitted.
+	Latency latency;
+	// Transaction request dispatched to its response being matched.
+	Latency transaction_latency;
+
+	void record_error(const std::string &where) {
+		add(errors);
+		std::lock_guard<std::mutex> lock(errors_mutex);
+		errors_by_where[where]++;
+	}
+
+	// Not atomic as a whole, increments racing with it may survive.
+	void reset() {
+		for (std::atomic<uint64_t> *value : { &rx_bytes, &rx_chunks, &read_calls, &tx_bytes, &tx_chunks, &write_calls, &monitor_wakeups, &empty_polls, &errors,
+					 &rx_buffer_high_water, &packet_queue_high_water, &tx_queue_high_water, &transactions_completed, &transactions_failed, &transaction_retries,
+					 &transactions_in_flight_high_water }) {
+			value->store(0, std::memory_order_relaxed);
+		}
+		latency.reset();
+		transaction_latency.reset();
+		std::lock_guard<std::mutex> lock(errors_mutex);
+		errors_by_where.clear();
+	}
+};
+
+#endif // SERIAL_PORT_STATS_H
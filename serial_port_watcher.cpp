@@ -0,0 +1,200 @@
+/*************************************************************************/
+/*  serial_port_watcher.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "serial_port_watcher.h"
+
+#include "serial/serial.h"
+
+#include <chrono>
+#include <cstring>
+#include <map>
+
+#ifdef __linux__
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+bool SerialPortWatcher::is_serial_device_name(const std::string &p_name) {
+	// Nodes of USB adapters, CDC ACM devices, on-board UARTs and Bluetooth RFCOMM.
+	static const char *prefixes[] = { "ttyUSB", "ttyACM", "ttyAMA", "ttyS", "ttyXRUSB", "ttyTHS", "rfcomm" };
+	for (const char *prefix : prefixes) {
+		if (p_name.compare(0, strlen(prefix), prefix) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void SerialPortWatcher::_thread_func(void *p_user_data) {
+	SerialPortWatcher *watcher = static_cast<SerialPortWatcher *>(p_user_data);
+#ifdef __linux__
+	if (watcher->inotify_fd >= 0) {
+		watcher->_watch_dev();
+		return;
+	}
+#endif
+	watcher->_rescan_loop();
+}
+
+#ifdef __linux__
+// udev sets the permissions of a new node after creating it, so it is only
+// reported once it can be opened, or after this long if it never can.
+static const int SETTLE_TIMEOUT_MSEC = 1000;
+static const int SETTLE_RETRY_MSEC = 20;
+
+void SerialPortWatcher::_watch_dev() {
+	alignas(struct inotify_event) char events[4096];
+	// New nodes not reported yet, with when to report them regardless.
+	std::map<std::string, std::chrono::steady_clock::time_point> settling;
+	while (!should_exit) {
+		struct pollfd fds[2] = {
+			{ wakeup_fds[0], POLLIN, 0 },
+			{ inotify_fd, POLLIN, 0 },
+		};
+		if (::poll(fds, 2, settling.empty() ? -1 : SETTLE_RETRY_MSEC) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			// Rescanning still works without inotify.
+			_rescan_loop();
+			return;
+		}
+		if (should_exit) {
+			break;
+		}
+
+		if (fds[1].revents & POLLIN) {
+			ssize_t size = ::read(inotify_fd, events, sizeof(events));
+			for (ssize_t offset = 0; offset < size;) {
+				const struct inotify_event *event = (const struct inotify_event *)(events + offset);
+				offset += sizeof(struct inotify_event) + event->len;
+				if (event->len == 0 || !is_serial_device_name(event->name)) {
+					continue;
+				}
+				std::string port = std::string("/dev/") + event->name;
+				if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+					settling[port] = std::chrono::steady_clock::now() + std::chrono::milliseconds(SETTLE_TIMEOUT_MSEC);
+				} else if (!settling.erase(port)) {
+					// Only ports reported added are reported removed.
+					callback(user_data, false, port);
+				}
+			}
+		}
+
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		for (auto it = settling.begin(); it != settling.end();) {
+			if (access(it->first.c_str(), R_OK | W_OK) == 0 || now >= it->second) {
+				callback(user_data, true, it->first);
+				it = settling.erase(it);
+			} else {
+				++it;
+			}
+		}
+	}
+}
+#endif
+
+void SerialPortWatcher::_rescan_loop() {
+	std::set<std::string> known;
+	bool first = true;
+	while (!should_exit) {
+		std::set<std::string> ports;
+		for (const serial::PortInfo &info : serial::list_ports()) {
+			ports.insert(info.port);
+		}
+		if (!first) {
+			for (const std::string &port : ports) {
+				if (!known.count(port)) {
+					callback(user_data, true, port);
+				}
+			}
+			for (const std::string &port : known) {
+				if (!ports.count(port)) {
+					callback(user_data, false, port);
+				}
+			}
+		}
+		known.swap(ports);
+		first = false;
+
+		for (int waited = 0; waited < rescan_interval && !should_exit; waited += 50) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		}
+	}
+}
+
+void SerialPortWatcher::start(Callback p_callback, void *p_user_data, int p_rescan_interval_msec) {
+	stop();
+	callback = p_callback;
+	user_data = p_user_data;
+	rescan_interval = p_rescan_interval_msec;
+	should_exit = false;
+#ifdef __linux__
+	inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (inotify_fd >= 0 && (inotify_add_watch(inotify_fd, "/dev", IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM) < 0 || pipe(wakeup_fds) != 0)) {
+		// Falls back to rescanning.
+		::close(inotify_fd);
+		inotify_fd = -1;
+	}
+#endif
+	thread = std::thread(_thread_func, this);
+}
+
+void SerialPortWatcher::stop() {
+	should_exit = true;
+#ifdef __linux__
+	if (wakeup_fds[1] >= 0) {
+		const uint8_t token = 0;
+		(void)!::write(wakeup_fds[1], &token, 1);
+	}
+#endif
+	if (thread.joinable()) {
+		thread.join();
+	}
+#ifdef __linux__
+	for (int &fd : wakeup_fds) {
+		if (fd >= 0) {
+			::close(fd);
+			fd = -1;
+		}
+	}
+	if (inotify_fd >= 0) {
+		::close(inotify_fd);
+		inotify_fd = -1;
+	}
+#endif
+}
+
+SerialPortWatcher::~SerialPortWatcher() {
+	stop();
+}
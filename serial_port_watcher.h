@@ -0,0 +1,74 @@
+/*************************************************************************/
+/*  serial_port_watcher.h                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef SERIAL_PORT_WATCHER_H
+#define SERIAL_PORT_WATCHER_H
+
+#include <atomic>
+#include <set>
+#include <string>
+#include <thread>
+
+// Reports serial ports appearing and disappearing from a thread of its own.
+// On Linux it waits for inotify events on /dev, elsewhere it compares
+// serial::list_ports() against the previous scan every `rescan_interval`.
+class SerialPortWatcher {
+public:
+	typedef void (*Callback)(void *p_user_data, bool p_added, const std::string &p_port);
+
+private:
+	std::thread thread;
+	std::atomic<bool> should_exit = false;
+	Callback callback = nullptr;
+	void *user_data = nullptr;
+	int rescan_interval = 1000;
+#ifdef __linux__
+	int inotify_fd = -1;
+	int wakeup_fds[2] = { -1, -1 };
+#endif
+
+	static void _thread_func(void *p_user_data);
+#ifdef __linux__
+	void _watch_dev();
+#endif
+	void _rescan_loop();
+
+public:
+	static bool is_serial_device_name(const std::string &p_name);
+
+	// `p_callback` is called on the watcher thread.
+	void start(Callback p_callback, void *p_user_data, int p_rescan_interval_msec = 1000);
+	void stop();
+	bool is_running() const { return thread.joinable(); }
+
+	~SerialPortWatcher();
+};
+
+#endif // SERIAL_PORT_WATCHER_H
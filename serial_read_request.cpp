@@ -0,0 +1,64 @@
+/*************************************************************************/
+/*  serial_read_request.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "serial_read_request.h"
+
+#ifdef GDEXTENSION
+#include <godot_cpp/core/class_db.hpp>
+#else
+#include "core/object/class_db.h"
+#endif
+
+void SerialReadRequest::_complete(Error p_error, const PackedByteArray &p_result) {
+	completed = true;
+	error = p_error;
+	result = p_result;
+	delimiter = PackedByteArray();
+}
+
+bool SerialReadRequest::is_completed() const {
+	return completed;
+}
+
+Error SerialReadRequest::get_error() const {
+	return error;
+}
+
+PackedByteArray SerialReadRequest::get_result() const {
+	return result;
+}
+
+void SerialReadRequest::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("is_completed"), &SerialReadRequest::is_completed);
+	ClassDB::bind_method(D_METHOD("get_error"), &SerialReadRequest::get_error);
+	ClassDB::bind_method(D_METHOD("get_result"), &SerialReadRequest::get_result);
+
+	ADD_SIGNAL(MethodInfo("completed", PropertyInfo(Variant::PACKED_BYTE_ARRAY, "result")));
+}
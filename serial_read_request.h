@@ -0,0 +1,74 @@
+/*************************************************************************/
+/*  serial_read_request.h                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef SERIAL_READ_REQUEST_H
+#define SERIAL_READ_REQUEST_H
+
+#ifdef GDEXTENSION
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+
+using namespace godot;
+#else
+#include "core/object/ref_counted.h"
+#endif
+
+#include <cstddef>
+
+// Pending `read_async()` or `read_until_async()` of a SerialPort.
+// The port completes it on the main thread, so `completed` can be awaited.
+class SerialReadRequest : public RefCounted {
+	GDCLASS(SerialReadRequest, RefCounted);
+
+	friend class SerialPort;
+
+	// Empty when waiting for an exact byte count.
+	PackedByteArray delimiter;
+	// Bytes to read, or the most to scan for the delimiter.
+	int size = 0;
+	// Stream offset the delimiter has been searched up to.
+	size_t scanned_position = 0;
+
+	bool completed = false;
+	Error error = OK;
+	PackedByteArray result;
+
+	void _complete(Error p_error, const PackedByteArray &p_result);
+
+public:
+	bool is_completed() const;
+	Error get_error() const;
+	PackedByteArray get_result() const;
+
+protected:
+	static void _bind_methods();
+};
+
+#endif // SERIAL_READ_REQUEST_H
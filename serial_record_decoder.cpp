@@ -0,0 +1,197 @@
+/*************************************************************************/
+/*  serial_record_decoder.cpp                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "serial_record_decoder.h"
+
+#include <cstring>
+
+static bool _is_host_big_endian() {
+	const uint16_t probe = 1;
+	uint8_t first;
+	memcpy(&first, &probe, 1);
+	return first == 0;
+}
+
+size_t SerialRecordDecoder::get_field_size(FieldType p_type) {
+	switch (p_type) {
+		case FIELD_INT8:
+		case FIELD_UINT8:
+			return 1;
+		case FIELD_INT16:
+		case FIELD_UINT16:
+			return 2;
+		case FIELD_INT32:
+		case FIELD_UINT32:
+		case FIELD_FLOAT32:
+			return 4;
+		case FIELD_INT64:
+		case FIELD_UINT64:
+		case FIELD_FLOAT64:
+			return 8;
+	}
+	return 1;
+}
+
+SerialRecordDecoder::ColumnType SerialRecordDecoder::get_column_type(FieldType p_type) {
+	switch (p_type) {
+		case FIELD_INT8:
+		case FIELD_UINT8:
+		case FIELD_INT16:
+		case FIELD_UINT16:
+		case FIELD_INT32:
+			return COLUMN_INT32;
+		case FIELD_UINT32:
+		case FIELD_INT64:
+		case FIELD_UINT64:
+			return COLUMN_INT64;
+		case FIELD_FLOAT32:
+			return COLUMN_FLOAT32;
+		case FIELD_FLOAT64:
+			return COLUMN_FLOAT64;
+	}
+	return COLUMN_INT32;
+}
+
+size_t SerialRecordDecoder::get_column_element_size(ColumnType p_type) {
+	return p_type == COLUMN_INT32 || p_type == COLUMN_FLOAT32 ? 4 : 8;
+}
+
+bool SerialRecordDecoder::set_fields(const std::vector<Field> &p_fields, size_t p_record_size) {
+	bool host_big_endian = _is_host_big_endian();
+	std::vector<Op> new_ops;
+	size_t next_offset = 0;
+	size_t end = 0;
+	for (const Field &field : p_fields) {
+		Op op;
+		op.offset = field.offset >= 0 ? size_t(field.offset) : next_offset;
+		op.size = get_field_size(field.type);
+		op.is_signed = field.type == FIELD_INT8 || field.type == FIELD_INT16 || field.type == FIELD_INT32 || field.type == FIELD_INT64;
+		op.is_float = field.type == FIELD_FLOAT32 || field.type == FIELD_FLOAT64;
+		op.swap = op.size > 1 && field.big_endian != host_big_endian;
+		op.column_type = get_column_type(field.type);
+		new_ops.push_back(op);
+		next_offset = op.offset + op.size;
+		end = next_offset > end ? next_offset : end;
+	}
+	if (p_record_size > 0 && end > p_record_size) {
+		return false;
+	}
+
+	fields = p_fields;
+	ops.swap(new_ops);
+	record_size = p_record_size > 0 ? p_record_size : end;
+	columns.clear();
+	for (const Op &op : ops) {
+		columns.push_back({ op.column_type, {} });
+	}
+	record_count = 0;
+	return true;
+}
+
+void SerialRecordDecoder::_decode_record(const uint8_t *record) {
+	for (size_t i = 0; i < ops.size(); i++) {
+		const Op &op = ops[i];
+		uint8_t raw[8];
+		if (op.swap) {
+			for (size_t j = 0; j < op.size; j++) {
+				raw[j] = record[op.offset + op.size - 1 - j];
+			}
+		} else {
+			memcpy(raw, record + op.offset, op.size);
+		}
+
+		Column &column = columns[i];
+		size_t element_size = get_column_element_size(column.type);
+		column.data.resize(column.data.size() + element_size);
+		uint8_t *dst = column.data.data() + column.data.size() - element_size;
+
+		if (op.is_float) {
+			// Floats keep their width, only the byte order changes.
+			memcpy(dst, raw, op.size);
+			continue;
+		}
+		int64_t value;
+		switch (op.size) {
+			case 1: {
+				value = op.is_signed ? int64_t(int8_t(raw[0])) : int64_t(raw[0]);
+			} break;
+			case 2: {
+				uint16_t v;
+				memcpy(&v, raw, 2);
+				value = op.is_signed ? int64_t(int16_t(v)) : int64_t(v);
+			} break;
+			case 4: {
+				uint32_t v;
+				memcpy(&v, raw, 4);
+				value = op.is_signed ? int64_t(int32_t(v)) : int64_t(v);
+			} break;
+			default: {
+				// uint64 wraps into int64, the same as everywhere else in Godot.
+				memcpy(&value, raw, 8);
+			} break;
+		}
+		if (column.type == COLUMN_INT32) {
+			int32_t narrow = int32_t(value);
+			memcpy(dst, &narrow, 4);
+		} else {
+			memcpy(dst, &value, 8);
+		}
+	}
+	record_count++;
+}
+
+void SerialRecordDecoder::decode(const uint8_t *data, size_t size) {
+	if (ops.empty() || record_size == 0) {
+		return;
+	}
+	size_t count = size / record_size;
+	if (count == 0 || size % record_size != 0) {
+		dropped_records++;
+	}
+	for (size_t i = 0; i < count; i++) {
+		_decode_record(data + i * record_size);
+	}
+}
+
+void SerialRecordDecoder::take_columns(std::vector<Column> &r_columns) {
+	r_columns.clear();
+	for (Column &column : columns) {
+		r_columns.push_back({ column.type, {} });
+		r_columns.back().data.swap(column.data);
+	}
+	record_count = 0;
+}
+
+void SerialRecordDecoder::clear() {
+	for (Column &column : columns) {
+		column.data.clear();
+	}
+	record_count = 0;
+}
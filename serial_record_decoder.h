@@ -0,0 +1,122 @@
+/*************************************************************************/
+/*  serial_record_decoder.h                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef SERIAL_RECORD_DECODER_H
+#define SERIAL_RECORD_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Unpacks fixed layout binary records into one typed column per field, so a
+// batch of records costs a handful of array copies instead of a Variant per
+// field.
+class SerialRecordDecoder {
+public:
+	enum FieldType {
+		FIELD_INT8,
+		FIELD_UINT8,
+		FIELD_INT16,
+		FIELD_UINT16,
+		FIELD_INT32,
+		FIELD_UINT32,
+		FIELD_INT64,
+		FIELD_UINT64,
+		FIELD_FLOAT32,
+		FIELD_FLOAT64,
+	};
+
+	// Integers up to 16 bits and int32 fit COLUMN_INT32, uint32 and 64 bit
+	// integers need COLUMN_INT64.
+	enum ColumnType {
+		COLUMN_INT32,
+		COLUMN_INT64,
+		COLUMN_FLOAT32,
+		COLUMN_FLOAT64,
+	};
+
+	struct Field {
+		std::string name;
+		FieldType type = FIELD_UINT8;
+		// Byte offset in the record, negative to follow the previous field.
+		int64_t offset = -1;
+		bool big_endian = false;
+	};
+
+	struct Column {
+		ColumnType type;
+		// Packed values in host byte order, `get_column_element_size()` each.
+		std::vector<uint8_t> data;
+	};
+
+private:
+	struct Op {
+		size_t offset;
+		size_t size;
+		bool is_signed;
+		bool is_float;
+		bool swap;
+		ColumnType column_type;
+	};
+
+	std::vector<Field> fields;
+	std::vector<Op> ops;
+	std::vector<Column> columns;
+	size_t record_size = 0;
+	size_t record_count = 0;
+	uint64_t dropped_records = 0;
+
+	void _decode_record(const uint8_t *record);
+
+public:
+	static size_t get_field_size(FieldType p_type);
+	static ColumnType get_column_type(FieldType p_type);
+	static size_t get_column_element_size(ColumnType p_type);
+
+	// Compiles the layout, `p_record_size` 0 makes records end after the last
+	// field. Returns false and keeps the previous schema if a field doesn't fit.
+	bool set_fields(const std::vector<Field> &p_fields, size_t p_record_size = 0);
+	const std::vector<Field> &get_fields() const { return fields; }
+	size_t get_record_size() const { return record_size; }
+	bool is_enabled() const { return !ops.empty(); }
+
+	// Decodes every whole record in `data`, a trailing partial record is dropped.
+	void decode(const uint8_t *data, size_t size);
+
+	size_t get_record_count() const { return record_count; }
+	uint64_t get_dropped_records() const { return dropped_records; }
+
+	// Hands the decoded columns over, in field order, and starts new ones.
+	void take_columns(std::vector<Column> &r_columns);
+	void clear();
+};
+
+#endif // SERIAL_RECORD_DECODER_H
@@ -0,0 +1,270 @@
+/*************************************************************************/
+/*  serial_replay.cpp                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "serial_replay.h"
+
+#include "serial_capture.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std::chrono;
+
+bool SerialReplay::_load_segment(const std::string &p_path, bool p_first) {
+	FILE *file = fopen(p_path.c_str(), "rb");
+	if (!file) {
+		return false;
+	}
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	// Read aside, the current segment stays intact if this one is rejected.
+	std::vector<uint8_t> data(size > 0 ? size : 0);
+	bool ok = fread(data.data(), 1, data.size(), file) == data.size();
+	fclose(file);
+
+	SerialCapture::SegmentHeader header;
+	if (!ok || data.size() < sizeof(header)) {
+		return false;
+	}
+	memcpy(&header, data.data(), sizeof(header));
+	if (memcmp(header.magic, SerialCapture::MAGIC, sizeof(header.magic)) != 0 || header.version != SerialCapture::VERSION || header.header_size < sizeof(header)) {
+		return false;
+	}
+	if (!p_first && (header.segment_index != segment_index + 1 || header.start_unix_usec != start_unix_usec)) {
+		return false;
+	}
+	segment.swap(data);
+	segment_index = header.segment_index;
+	start_unix_usec = header.start_unix_usec;
+	scan = header.header_size;
+	segment_end = std::min(size_t(header.end), segment.size());
+	return true;
+}
+
+bool SerialReplay::_next_chunk(uint64_t &r_time_usec, const uint8_t *&r_data, size_t &r_size) {
+	while (true) {
+		if (scan + sizeof(SerialCapture::RecordHeader) > segment_end) {
+			if (!_load_segment(SerialCapture::get_segment_path(base_path, segment_index + 1), false)) {
+				return false;
+			}
+			continue;
+		}
+		SerialCapture::RecordHeader record;
+		memcpy(&record, segment.data() + scan, sizeof(record));
+		size_t data_offset = scan + sizeof(record);
+		if (record.size > segment_end - data_offset) {
+			// Truncated record, the capture ends here.
+			return false;
+		}
+		scan = data_offset + ((size_t(record.size) + 7) & ~size_t(7));
+		if (record.direction == SerialCapture::DIRECTION_RX && record.size > 0) {
+			r_time_usec = record.time_usec;
+			r_data = segment.data() + data_offset;
+			r_size = record.size;
+			return true;
+		}
+	}
+}
+
+void SerialReplay::_set_readable(bool p_readable) {
+#ifndef _WIN32
+	// The pipe holds one token exactly while data is buffered, like the input
+	// queue of a tty.
+	if (p_readable) {
+		const uint8_t token = 0;
+		(void)!::write(readable_fds[1], &token, 1);
+	} else {
+		uint8_t token;
+		while (::read(readable_fds[0], &token, 1) > 0) {
+		}
+	}
+#endif
+}
+
+void SerialReplay::_finish() {
+	if (finished_callback) {
+		finished_callback(finished_user_data);
+	}
+}
+
+void SerialReplay::_thread_func(void *p_user_data) {
+	SerialReplay *replay = static_cast<SerialReplay *>(p_user_data);
+	replay->_feed();
+}
+
+void SerialReplay::_feed() {
+	steady_clock::time_point start = steady_clock::now();
+	bool has_origin = false;
+	uint64_t origin = 0;
+
+	std::unique_lock<std::mutex> lock(mutex);
+	while (!should_exit) {
+		uint64_t time_usec;
+		const uint8_t *data;
+		size_t size;
+		if (!_next_chunk(time_usec, data, size)) {
+			finished = true;
+			cond.notify_all();
+			if (buffer_start == buffer.size()) {
+				lock.unlock();
+				_finish();
+			}
+			return;
+		}
+
+		// Time is counted from the first chunk, playback may start at any segment.
+		if (!has_origin) {
+			origin = time_usec;
+			has_origin = true;
+		}
+		if (speed > 0.0) {
+			steady_clock::time_point release_at = start + microseconds(uint64_t((time_usec - std::min(time_usec, origin)) / speed));
+			cond.wait_until(lock, release_at, [this] { return should_exit; });
+		}
+		cond.wait(lock, [this] { return should_exit || buffer.size() - buffer_start < MAX_BUFFERED; });
+		if (should_exit) {
+			break;
+		}
+
+		if (buffer_start == buffer.size()) {
+			buffer.clear();
+			buffer_start = 0;
+			_set_readable(true);
+		} else if (buffer_start > buffer.size() / 2) {
+			buffer.erase(buffer.begin(), buffer.begin() + buffer_start);
+			buffer_start = 0;
+		}
+		buffer.insert(buffer.end(), data, data + size);
+		cond.notify_all();
+	}
+}
+
+bool SerialReplay::open(const std::string &p_path, double p_speed, FinishedCallback p_callback, void *p_user_data) {
+	close();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!_load_segment(p_path, true)) {
+		return false;
+	}
+	base_path = p_path;
+	std::string suffix = "." + std::to_string(segment_index);
+	if (segment_index > 0 && base_path.size() > suffix.size() && base_path.compare(base_path.size() - suffix.size(), suffix.size(), suffix) == 0) {
+		base_path.resize(base_path.size() - suffix.size());
+	}
+#ifndef _WIN32
+	if (pipe(readable_fds) != 0) {
+		return false;
+	}
+	fcntl(readable_fds[0], F_SETFL, fcntl(readable_fds[0], F_GETFL) | O_NONBLOCK);
+	fcntl(readable_fds[1], F_SETFL, fcntl(readable_fds[1], F_GETFL) | O_NONBLOCK);
+#endif
+
+	speed = p_speed;
+	finished_callback = p_callback;
+	finished_user_data = p_user_data;
+	should_exit = false;
+	finished = false;
+	buffer.clear();
+	buffer_start = 0;
+	thread = std::thread(_thread_func, this);
+	active.store(true, std::memory_order_relaxed);
+	return true;
+}
+
+void SerialReplay::close() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		active.store(false, std::memory_order_relaxed);
+		should_exit = true;
+	}
+	cond.notify_all();
+	if (thread.joinable()) {
+		thread.join();
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+#ifndef _WIN32
+	for (int &fd : readable_fds) {
+		if (fd >= 0) {
+			::close(fd);
+			fd = -1;
+		}
+	}
+#endif
+	segment.clear();
+	buffer.clear();
+	buffer_start = 0;
+}
+
+size_t SerialReplay::available() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return buffer.size() - buffer_start;
+}
+
+size_t SerialReplay::read(uint8_t *p_buffer, size_t p_size, uint32_t p_timeout_msec) {
+	std::unique_lock<std::mutex> lock(mutex);
+	cond.wait_for(lock, milliseconds(p_timeout_msec), [this, p_size] {
+		return should_exit || finished || buffer.size() - buffer_start >= p_size;
+	});
+
+	size_t size = std::min(p_size, buffer.size() - buffer_start);
+	memcpy(p_buffer, buffer.data() + buffer_start, size);
+	buffer_start += size;
+	bool drained = size > 0 && buffer_start == buffer.size();
+	if (drained) {
+		_set_readable(false);
+	}
+	// Wakes the feeder if it waits for room.
+	cond.notify_all();
+	if (drained && finished) {
+		lock.unlock();
+		_finish();
+	}
+	return size;
+}
+
+bool SerialReplay::wait_readable(uint32_t p_timeout_msec) {
+	std::unique_lock<std::mutex> lock(mutex);
+	return cond.wait_for(lock, milliseconds(p_timeout_msec), [this] {
+		return should_exit || buffer_start < buffer.size();
+	}) && buffer_start < buffer.size();
+}
+
+SerialReplay::~SerialReplay() {
+	close();
+}
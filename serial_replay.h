@@ -0,0 +1,109 @@
+/*************************************************************************/
+/*  serial_replay.h                                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef SERIAL_REPLAY_H
+#define SERIAL_REPLAY_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Plays the received side of a SerialCapture back as if a device sent it.
+// A feeder thread releases each recorded chunk at its recorded time, divided
+// by the speed, and readers see it through available(), read() and, outside
+// Windows, a descriptor that is readable whenever data is buffered.
+class SerialReplay {
+public:
+	typedef void (*FinishedCallback)(void *p_user_data);
+
+private:
+	// Data ahead of the reader is capped, so fast playback can't load the whole
+	// capture in memory.
+	static const size_t MAX_BUFFERED = 1 << 20;
+
+	std::mutex mutex;
+	std::condition_variable cond;
+	std::thread thread;
+	bool should_exit = false;
+	bool finished = false;
+	std::atomic<bool> active = false;
+
+	std::string base_path;
+	uint64_t segment_index = 0;
+	// Of the capture being played, its later segments must have the same.
+	uint64_t start_unix_usec = 0;
+	std::vector<uint8_t> segment;
+	size_t scan = 0;
+	size_t segment_end = 0;
+
+	double speed = 1.0;
+	std::vector<uint8_t> buffer;
+	size_t buffer_start = 0;
+#ifndef _WIN32
+	int readable_fds[2] = { -1, -1 };
+#endif
+
+	FinishedCallback finished_callback = nullptr;
+	void *finished_user_data = nullptr;
+
+	// Loads the segment at `p_path`. Unless `p_first`, it must continue the
+	// one loaded before, which a segment left by an earlier capture doesn't.
+	bool _load_segment(const std::string &p_path, bool p_first);
+	// Points `r_data` at the next received chunk, false at the end of the capture.
+	bool _next_chunk(uint64_t &r_time_usec, const uint8_t *&r_data, size_t &r_size);
+	void _set_readable(bool p_readable);
+	void _finish();
+	static void _thread_func(void *p_user_data);
+	void _feed();
+
+public:
+	// `p_speed` 0 plays as fast as the reader takes the data.
+	bool open(const std::string &p_path, double p_speed, FinishedCallback p_callback, void *p_user_data);
+	void close();
+	bool is_open() const { return active.load(std::memory_order_relaxed); }
+
+	size_t available();
+	// Waits up to `p_timeout_msec` for `p_size` bytes, returns what was read.
+	size_t read(uint8_t *p_buffer, size_t p_size, uint32_t p_timeout_msec);
+	bool wait_readable(uint32_t p_timeout_msec);
+#ifndef _WIN32
+	// Readable while data is buffered, owned by the replay.
+	int get_readable_fd() const { return readable_fds[0]; }
+#endif
+
+	~SerialReplay();
+};
+
+#endif // SERIAL_REPLAY_H
@@ -0,0 +1,178 @@
+/*************************************************************************/
+/*  serial_transaction_queue.cpp                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "serial_transaction_queue.h"
+
+#include <algorithm>
+
+void SerialTransactionQueue::set_id_field(size_t p_offset, size_t p_size, bool p_big_endian) {
+	id_field_offset = p_offset;
+	id_field_size = p_size;
+	id_field_big_endian = p_big_endian;
+}
+
+bool SerialTransactionQueue::read_id(const uint8_t *p_data, size_t p_size, int64_t *r_id) const {
+	if (p_size < id_field_offset + id_field_size) {
+		return false;
+	}
+	const uint8_t *field = p_data + id_field_offset;
+	uint64_t value = 0;
+	for (size_t i = 0; i < id_field_size; i++) {
+		uint8_t byte = id_field_big_endian ? field[i] : field[id_field_size - 1 - i];
+		value = (value << 8) | byte;
+	}
+	*r_id = int64_t(value);
+	return true;
+}
+
+bool SerialTransactionQueue::submit(int64_t p_id, const uint8_t *p_request, size_t p_size, uint64_t p_timeout_usec, int p_retries) {
+	if (in_flight.count(p_id) > 0) {
+		return false;
+	}
+	for (const Transaction &transaction : waiting) {
+		if (transaction.id == p_id) {
+			return false;
+		}
+	}
+
+	Transaction transaction;
+	transaction.id = p_id;
+	transaction.request.assign(p_request, p_request + p_size);
+	transaction.timeout_usec = p_timeout_usec;
+	transaction.retries_left = p_retries;
+	waiting.push_back(std::move(transaction));
+	return true;
+}
+
+bool SerialTransactionQueue::dispatch(int64_t *r_id, std::vector<uint8_t> &r_request) {
+	if (!can_dispatch()) {
+		return false;
+	}
+	Transaction transaction = std::move(waiting.front());
+	waiting.pop_front();
+	transaction.attempts++;
+	transaction.sent = false;
+	r_request = transaction.request;
+	*r_id = transaction.id;
+	in_flight.emplace(transaction.id, std::move(transaction));
+	return true;
+}
+
+void SerialTransactionQueue::mark_sent(int64_t p_id, uint64_t p_now_usec) {
+	auto it = in_flight.find(p_id);
+	// Gone if a response to an earlier attempt completed it meanwhile.
+	if (it != in_flight.end()) {
+		it->second.sent = true;
+		it->second.sent_usec = p_now_usec;
+	}
+}
+
+bool SerialTransactionQueue::match(const uint8_t *p_data, size_t p_size, uint64_t p_now_usec, Completion &r_completion) {
+	int64_t id;
+	if (!read_id(p_data, p_size, &id)) {
+		return false;
+	}
+	auto it = in_flight.find(id);
+	if (it == in_flight.end()) {
+		return false;
+	}
+
+	r_completion.id = id;
+	r_completion.status = STATUS_COMPLETED;
+	r_completion.response.assign(p_data, p_data + p_size);
+	// A response may beat the writer marking its request sent.
+	r_completion.latency_usec = it->second.sent ? p_now_usec - it->second.sent_usec : 0;
+	r_completion.attempts = it->second.attempts;
+	in_flight.erase(it);
+	return true;
+}
+
+int SerialTransactionQueue::expire(uint64_t p_now_usec, std::vector<Completion> &r_failed) {
+	std::vector<Transaction> overdue;
+	for (auto it = in_flight.begin(); it != in_flight.end();) {
+		if (it->second.sent && p_now_usec - it->second.sent_usec >= it->second.timeout_usec) {
+			overdue.push_back(std::move(it->second));
+			it = in_flight.erase(it);
+		} else {
+			++it;
+		}
+	}
+	// Retried in the order they were first sent, ahead of newer requests.
+	std::sort(overdue.begin(), overdue.end(), [](const Transaction &a, const Transaction &b) { return a.sent_usec < b.sent_usec; });
+
+	int retried = 0;
+	for (auto it = overdue.rbegin(); it != overdue.rend(); ++it) {
+		if (it->retries_left > 0) {
+			it->retries_left--;
+			waiting.push_front(std::move(*it));
+			retried++;
+			continue;
+		}
+		Completion completion;
+		completion.id = it->id;
+		completion.status = STATUS_TIMED_OUT;
+		completion.attempts = it->attempts;
+		r_failed.push_back(std::move(completion));
+	}
+	return retried;
+}
+
+uint64_t SerialTransactionQueue::get_next_deadline() const {
+	uint64_t deadline = 0;
+	for (const std::pair<const int64_t, Transaction> &entry : in_flight) {
+		if (!entry.second.sent) {
+			continue;
+		}
+		uint64_t expires = entry.second.sent_usec + entry.second.timeout_usec;
+		if (deadline == 0 || expires < deadline) {
+			deadline = expires;
+		}
+	}
+	return deadline;
+}
+
+void SerialTransactionQueue::cancel(std::vector<Completion> &r_cancelled) {
+	for (const std::pair<const int64_t, Transaction> &entry : in_flight) {
+		Completion completion;
+		completion.id = entry.first;
+		completion.status = STATUS_CANCELLED;
+		completion.attempts = entry.second.attempts;
+		r_cancelled.push_back(std::move(completion));
+	}
+	for (const Transaction &transaction : waiting) {
+		Completion completion;
+		completion.id = transaction.id;
+		completion.status = STATUS_CANCELLED;
+		completion.attempts = transaction.attempts;
+		r_cancelled.push_back(std::move(completion));
+	}
+	in_flight.clear();
+	waiting.clear();
+}
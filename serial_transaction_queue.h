@@ -0,0 +1,117 @@
+/*************************************************************************/
+/*  serial_transaction_queue.h                                           */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef SERIAL_TRANSACTION_QUEUE_H
+#define SERIAL_TRANSACTION_QUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+// Bookkeeping of pipelined request/response transactions. Requests wait for
+// one of the in-flight slots, responses are matched to them by an ID field
+// and overdue requests are sent again while retries are left. Not
+// thread-safe, the owner serializes access.
+class SerialTransactionQueue {
+public:
+	enum Status {
+		STATUS_COMPLETED,
+		STATUS_TIMED_OUT,
+		STATUS_CANCELLED,
+	};
+
+	struct Completion {
+		int64_t id = 0;
+		Status status = STATUS_COMPLETED;
+		std::vector<uint8_t> response;
+		// From the last attempt being written out to its response.
+		uint64_t latency_usec = 0;
+		int attempts = 0;
+	};
+
+private:
+	struct Transaction {
+		int64_t id = 0;
+		std::vector<uint8_t> request;
+		uint64_t timeout_usec = 0;
+		int retries_left = 0;
+		int attempts = 0;
+		// Set once the writer has put the attempt on the wire, only then does
+		// its timeout run.
+		bool sent = false;
+		uint64_t sent_usec = 0;
+	};
+
+	std::deque<Transaction> waiting;
+	std::unordered_map<int64_t, Transaction> in_flight;
+	size_t max_in_flight = 8;
+
+	size_t id_field_offset = 0;
+	size_t id_field_size = 1;
+	bool id_field_big_endian = false;
+
+public:
+	void set_max_in_flight(size_t p_count) { max_in_flight = p_count; }
+	size_t get_max_in_flight() const { return max_in_flight; }
+
+	void set_id_field(size_t p_offset, size_t p_size, bool p_big_endian);
+	size_t get_id_field_offset() const { return id_field_offset; }
+	size_t get_id_field_size() const { return id_field_size; }
+	bool is_id_field_big_endian() const { return id_field_big_endian; }
+
+	// Reads the ID field of a response, false if it is too short to hold one.
+	bool read_id(const uint8_t *p_data, size_t p_size, int64_t *r_id) const;
+
+	// False if a transaction with the same ID is still pending.
+	bool submit(int64_t p_id, const uint8_t *p_request, size_t p_size, uint64_t p_timeout_usec, int p_retries);
+	bool can_dispatch() const { return !waiting.empty() && in_flight.size() < max_in_flight; }
+	// Takes the next request a slot is free for. It is in flight but its
+	// timeout only starts with mark_sent().
+	bool dispatch(int64_t *r_id, std::vector<uint8_t> &r_request);
+	// The request of transaction `p_id` was written out completely.
+	void mark_sent(int64_t p_id, uint64_t p_now_usec);
+	// Completes the transaction the response belongs to, false if none does.
+	bool match(const uint8_t *p_data, size_t p_size, uint64_t p_now_usec, Completion &r_completion);
+	// Queues overdue transactions with retries left ahead of the waiting ones
+	// and fails the others. Returns the number queued again. Attempts not
+	// written out yet are never overdue, so none is sent twice at once.
+	int expire(uint64_t p_now_usec, std::vector<Completion> &r_failed);
+	// Earliest time a transaction sent times out, 0 if none is waiting for a
+	// response.
+	uint64_t get_next_deadline() const;
+	void cancel(std::vector<Completion> &r_cancelled);
+
+	size_t get_in_flight_count() const { return in_flight.size(); }
+	size_t get_waiting_count() const { return waiting.size(); }
+};
+
+#endif // SERIAL_TRANSACTION_QUEUE_H
@@ -0,0 +1,82 @@
+/*************************************************************************/
+/*  serial_tx_pacer.cpp                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "serial_tx_pacer.h"
+
+#include <algorithm>
+#include <cmath>
+
+double SerialTxPacer::get_byte_time_usec(uint32_t p_baudrate, int p_bytesize, bool p_parity, double p_stopbits) {
+	if (p_baudrate == 0) {
+		return 0.0;
+	}
+	double bits = 1 + p_bytesize + (p_parity ? 1 : 0) + p_stopbits;
+	return bits * 1000000.0 / p_baudrate;
+}
+
+void SerialTxPacer::reset() {
+	tokens = 0.0;
+	refill_usec = 0;
+	resume_usec = 0;
+}
+
+size_t SerialTxPacer::acquire(uint64_t p_now_usec, size_t p_size, uint64_t *r_wait_usec) {
+	if (p_now_usec < resume_usec) {
+		*r_wait_usec = resume_usec - p_now_usec;
+		return 0;
+	}
+	size_t size = std::min(p_size, burst);
+	if (rate <= 0.0 || byte_usec <= 0.0) {
+		return size;
+	}
+
+	if (refill_usec == 0) {
+		tokens = burst;
+	} else {
+		tokens = std::min(double(burst), tokens + (p_now_usec - refill_usec) * rate / byte_usec);
+	}
+	refill_usec = p_now_usec;
+	// Wait for the whole chunk rather than trickling single bytes out.
+	if (tokens < size) {
+		*r_wait_usec = std::max<uint64_t>(1, uint64_t(std::ceil((size - tokens) * byte_usec / rate)));
+		return 0;
+	}
+	return size;
+}
+
+void SerialTxPacer::commit(uint64_t p_now_usec, size_t p_size) {
+	if (rate > 0.0) {
+		tokens -= p_size;
+	}
+	if (gap_usec > 0) {
+		// write() returns once the bytes are queued, not sent.
+		resume_usec = p_now_usec + uint64_t(p_size * byte_usec) + gap_usec;
+	}
+}
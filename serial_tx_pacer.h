@@ -0,0 +1,78 @@
+/*************************************************************************/
+/*  serial_tx_pacer.h                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef SERIAL_TX_PACER_H
+#define SERIAL_TX_PACER_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Spaces writes out for receivers without flow control: a token bucket
+// refilled at a fraction of the line rate and holding at most `burst` bytes,
+// the size of the receiver's FIFO, plus an optional gap after every chunk
+// once it has left the wire. Not thread-safe, the owner serializes access.
+class SerialTxPacer {
+	// Fraction of the line rate, 0 for no limit.
+	double rate = 0.0;
+	size_t burst = 16;
+	uint64_t gap_usec = 0;
+	// Time one byte takes on the wire, start and stop bits included.
+	double byte_usec = 0.0;
+
+	double tokens = 0.0;
+	// 0 until the first chunk, the bucket starts out full.
+	uint64_t refill_usec = 0;
+	uint64_t resume_usec = 0;
+
+public:
+	static double get_byte_time_usec(uint32_t p_baudrate, int p_bytesize, bool p_parity, double p_stopbits);
+
+	void set_rate(double p_rate) { rate = p_rate; }
+	double get_rate() const { return rate; }
+
+	void set_burst(size_t p_burst) { burst = p_burst; }
+	size_t get_burst() const { return burst; }
+
+	void set_gap_usec(uint64_t p_gap_usec) { gap_usec = p_gap_usec; }
+	uint64_t get_gap_usec() const { return gap_usec; }
+
+	void set_byte_time_usec(double p_byte_usec) { byte_usec = p_byte_usec; }
+
+	bool is_enabled() const { return rate > 0.0 || gap_usec > 0; }
+	void reset();
+
+	// Bytes out of `p_size` that may be written at `p_now_usec`, or 0 with
+	// the time left to wait in `r_wait_usec`.
+	size_t acquire(uint64_t p_now_usec, size_t p_size, uint64_t *r_wait_usec);
+	// Charges the bytes written at `p_now_usec`.
+	void commit(uint64_t p_now_usec, size_t p_size);
+};
+
+#endif // SERIAL_TX_PACER_H
@@ -0,0 +1,139 @@
+/*************************************************************************/
+/*  spsc_ring_buffer.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef SPSC_RING_BUFFER_H
+#define SPSC_RING_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Fixed capacity byte ring shared by exactly one producer thread and one
+// consumer thread. Neither side ever blocks or takes a lock: the producer only
+// advances `head`, the consumer only advances `tail`.
+class SPSCRingBuffer {
+	std::vector<uint8_t> data;
+	size_t mask = 0;
+
+	alignas(64) std::atomic<size_t> head = 0;
+	alignas(64) std::atomic<size_t> tail = 0;
+
+public:
+	// Not thread safe, only call while neither side is running.
+	void resize(size_t capacity) {
+		size_t size = 1;
+		while (size < capacity) {
+			size <<= 1;
+		}
+		data.assign(size, 0);
+		mask = size - 1;
+		head = 0;
+		tail = 0;
+	}
+
+	size_t capacity() const { return data.size(); }
+
+	// Readable bytes, exact on the consumer side and a lower bound elsewhere.
+	size_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+
+	size_t space() const { return capacity() - size(); }
+
+	// Total bytes ever committed and consumed, to tie side data to stream offsets.
+	size_t get_write_position() const { return head.load(std::memory_order_acquire); }
+	size_t get_read_position() const { return tail.load(std::memory_order_acquire); }
+
+	// Producer side.
+
+	// Contiguous writable region, fill it then publish with commit_write().
+	size_t get_write_span(uint8_t **r_ptr) {
+		size_t h = head.load(std::memory_order_relaxed);
+		size_t free = capacity() - (h - tail.load(std::memory_order_acquire));
+		size_t offset = h & mask;
+		*r_ptr = data.data() + offset;
+		return free < capacity() - offset ? free : capacity() - offset;
+	}
+
+	void commit_write(size_t size) { head.store(head.load(std::memory_order_relaxed) + size, std::memory_order_release); }
+
+	size_t write(const uint8_t *src, size_t size) {
+		size_t written = 0;
+		while (written < size) {
+			uint8_t *dst;
+			size_t span = get_write_span(&dst);
+			if (span == 0) {
+				break;
+			}
+			span = span < size - written ? span : size - written;
+			memcpy(dst, src + written, span);
+			commit_write(span);
+			written += span;
+		}
+		return written;
+	}
+
+	// Consumer side.
+
+	// Contiguous readable region `skipped` bytes past the read position,
+	// consume it with skip().
+	size_t get_read_span(const uint8_t **r_ptr, size_t skipped = 0) const {
+		size_t t = tail.load(std::memory_order_relaxed);
+		size_t readable = head.load(std::memory_order_acquire) - t;
+		readable = skipped < readable ? readable - skipped : 0;
+		size_t offset = (t + skipped) & mask;
+		*r_ptr = data.data() + offset;
+		return readable < capacity() - offset ? readable : capacity() - offset;
+	}
+
+	size_t peek(uint8_t *dst, size_t size, size_t skipped = 0) const {
+		size_t t = tail.load(std::memory_order_relaxed);
+		size_t readable = head.load(std::memory_order_acquire) - t;
+		readable = skipped < readable ? readable - skipped : 0;
+		t += skipped;
+		size = size < readable ? size : readable;
+		size_t offset = t & mask;
+		size_t first = size < capacity() - offset ? size : capacity() - offset;
+		memcpy(dst, data.data() + offset, first);
+		memcpy(dst + first, data.data(), size - first);
+		return size;
+	}
+
+	void skip(size_t size) { tail.store(tail.load(std::memory_order_relaxed) + size, std::memory_order_release); }
+
+	size_t read(uint8_t *dst, size_t size) {
+		size = peek(dst, size);
+		skip(size);
+		return size;
+	}
+
+	void clear() { tail.store(head.load(std::memory_order_acquire), std::memory_order_release); }
+};
+
+#endif // SPSC_RING_BUFFER_H